@@ -0,0 +1,158 @@
+#include "achievements.h"
+#include <algorithm>
+#include <stdexcept>
+
+// AchievementCatalog implementation
+AchievementCatalog::AchievementCatalog() {
+    const std::vector<std::int64_t> bossTiers = {1, 5, 10, 25, 50, 100, 250};
+    const std::vector<std::int64_t> clearTiers = {1, 5, 10, 25, 50, 100};
+
+    addTiers(AchievementCounter::FLOORS_CLEARED,
+             {1, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000},
+             "floors", "Clear {n} floor", "Clear {n} floors");
+    addTiers(AchievementCounter::ENEMIES_DEFEATED,
+             {1, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000},
+             "enemies", "Defeat {n} enemy", "Defeat {n} enemies");
+    addTiers(AchievementCounter::DUNGEONS_COMPLETED,
+             {1, 5, 10, 25, 50, 100, 250, 500, 1000, 5000},
+             "dungeons", "Complete {n} dungeon", "Complete {n} dungeons");
+
+    addTiers(AchievementCounter::BOSSES_FOREST, bossTiers, "boss_forest",
+             "Defeat {n} Forest boss", "Defeat {n} Forest bosses");
+    addTiers(AchievementCounter::BOSSES_CAVE, bossTiers, "boss_cave",
+             "Defeat {n} Cave boss", "Defeat {n} Cave bosses");
+    addTiers(AchievementCounter::BOSSES_DESERT, bossTiers, "boss_desert",
+             "Defeat {n} Desert boss", "Defeat {n} Desert bosses");
+    addTiers(AchievementCounter::BOSSES_ICE, bossTiers, "boss_ice",
+             "Defeat {n} Ice Cavern boss", "Defeat {n} Ice Cavern bosses");
+    addTiers(AchievementCounter::BOSSES_VOLCANO, bossTiers, "boss_volcano",
+             "Defeat {n} Volcano boss", "Defeat {n} Volcano bosses");
+
+    addTiers(AchievementCounter::CLEARS_SMALL, clearTiers, "clear_small",
+             "Complete {n} Small dungeon", "Complete {n} Small dungeons");
+    addTiers(AchievementCounter::CLEARS_MEDIUM, clearTiers, "clear_medium",
+             "Complete {n} Medium dungeon", "Complete {n} Medium dungeons");
+    addTiers(AchievementCounter::CLEARS_LARGE, clearTiers, "clear_large",
+             "Complete {n} Large dungeon", "Complete {n} Large dungeons");
+    addTiers(AchievementCounter::CLEARS_EPIC, clearTiers, "clear_epic",
+             "Complete {n} Epic dungeon", "Complete {n} Epic dungeons");
+    addTiers(AchievementCounter::NO_DAMAGE_CLEARS, clearTiers, "flawless",
+             "Complete {n} dungeon without taking damage",
+             "Complete {n} dungeons without taking damage");
+
+    addTiers(AchievementCounter::GOLD_EARNED,
+             {100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000},
+             "gold", "Earn {n} gold", "Earn {n} gold");
+    addTiers(AchievementCounter::LEVEL, {2, 5, 10, 15, 20, 25, 30, 40, 50, 75, 100},
+             "level", "Reach level {n}", "Reach level {n}");
+    addTiers(AchievementCounter::DEATHS, {1, 10, 100, 1000},
+             "deaths", "Fall in battle {n} time", "Fall in battle {n} times");
+    addTiers(AchievementCounter::DAMAGE_DEALT,
+             {1000, 10000, 100000, 1000000, 10000000, 100000000},
+             "damage", "Deal {n} damage", "Deal {n} damage");
+    addTiers(AchievementCounter::UPGRADES_BOUGHT, {1, 5, 10, 25, 50, 100},
+             "upgrades", "Buy {n} upgrade", "Buy {n} upgrades");
+    addTiers(AchievementCounter::ITEMS_FOUND, {1, 10, 100, 1000, 10000},
+             "items", "Find {n} item", "Find {n} items");
+
+    // Trackers keep a fixed-size bitset, so an oversized catalog fails on
+    // launch instead of when a late achievement unlocks mid-game
+    if (achievements.size() > MAX_ACHIEVEMENTS) {
+        throw std::length_error("achievement catalog has " + std::to_string(achievements.size()) +
+                                " entries, more than MAX_ACHIEVEMENTS");
+    }
+}
+
+void AchievementCatalog::addTiers(AchievementCounter counter,
+                                  const std::vector<std::int64_t>& thresholds,
+                                  const std::string& keyPrefix, const std::string& singular,
+                                  const std::string& plural) {
+    auto& index = thresholdIndex[static_cast<std::size_t>(counter)];
+    for (std::int64_t threshold : thresholds) {
+        std::string name = threshold == 1 ? singular : plural;
+        name.replace(name.find("{n}"), 3, std::to_string(threshold));
+
+        index.push_back(static_cast<std::uint16_t>(achievements.size()));
+        achievements.push_back({keyPrefix + "_" + std::to_string(threshold), name, counter, threshold});
+    }
+
+    std::sort(index.begin(), index.end(), [this](std::uint16_t a, std::uint16_t b) {
+        return achievements[a].threshold < achievements[b].threshold;
+    });
+}
+
+const AchievementCatalog& AchievementCatalog::instance() {
+    static const AchievementCatalog catalog;
+    return catalog;
+}
+
+const std::vector<Achievement>& AchievementCatalog::all() const {
+    return achievements;
+}
+
+const Achievement& AchievementCatalog::get(std::size_t id) const {
+    return achievements[id];
+}
+
+const std::vector<std::uint16_t>& AchievementCatalog::forCounter(AchievementCounter counter) const {
+    return thresholdIndex[static_cast<std::size_t>(counter)];
+}
+
+int AchievementCatalog::findByKey(const std::string& key) const {
+    for (std::size_t i = 0; i < achievements.size(); i++) {
+        if (achievements[i].key == key) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// AchievementTracker implementation
+AchievementTracker::AchievementTracker() {
+    counters.fill(0);
+    cursor.fill(0);
+}
+
+std::int64_t AchievementTracker::get(AchievementCounter counter) const {
+    return counters[static_cast<std::size_t>(counter)];
+}
+
+bool AchievementTracker::isUnlocked(std::size_t id) const {
+    return id < MAX_ACHIEVEMENTS && unlocked.test(id);
+}
+
+std::size_t AchievementTracker::unlockedCount() const {
+    return unlocked.count();
+}
+
+int AchievementTracker::nextFor(AchievementCounter counter) const {
+    std::size_t c = static_cast<std::size_t>(counter);
+    const auto& index = AchievementCatalog::instance().forCounter(counter);
+    return cursor[c] < index.size() ? index[cursor[c]] : -1;
+}
+
+int AchievementTracker::lastFor(AchievementCounter counter) const {
+    std::size_t c = static_cast<std::size_t>(counter);
+    const auto& index = AchievementCatalog::instance().forCounter(counter);
+    return cursor[c] > 0 ? index[cursor[c] - 1] : -1;
+}
+
+void AchievementTracker::restore(const std::array<std::int64_t, ACHIEVEMENT_COUNTER_COUNT>& values,
+                                 const std::vector<std::string>& unlockedKeys) {
+    const AchievementCatalog& catalog = AchievementCatalog::instance();
+    counters = values;
+    cursor.fill(0);
+    unlocked.reset();
+
+    for (const auto& key : unlockedKeys) {
+        int id = catalog.findByKey(key);
+        if (id >= 0) {
+            unlocked.set(id);
+        }
+    }
+
+    // Achievements added since the save was written unlock retroactively
+    for (std::size_t c = 0; c < ACHIEVEMENT_COUNTER_COUNT; c++) {
+        advance(c, [](std::uint16_t) {});
+    }
+}
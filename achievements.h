@@ -0,0 +1,128 @@
+#ifndef ACHIEVEMENTS_H
+#define ACHIEVEMENTS_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+
+// Counters that achievements are defined against. Saves store them in this
+// order, so new counters must be appended before COUNT.
+enum class AchievementCounter : std::uint8_t {
+    FLOORS_CLEARED,
+    ENEMIES_DEFEATED,
+    DUNGEONS_COMPLETED,
+    BOSSES_FOREST,
+    BOSSES_CAVE,
+    BOSSES_DESERT,
+    BOSSES_ICE,
+    BOSSES_VOLCANO,
+    CLEARS_SMALL,
+    CLEARS_MEDIUM,
+    CLEARS_LARGE,
+    CLEARS_EPIC,
+    NO_DAMAGE_CLEARS,
+    GOLD_EARNED,
+    LEVEL,
+    DEATHS,
+    DAMAGE_DEALT,
+    UPGRADES_BOUGHT,
+    ITEMS_FOUND,
+    COUNT
+};
+
+const std::size_t ACHIEVEMENT_COUNTER_COUNT = static_cast<std::size_t>(AchievementCounter::COUNT);
+// Capacity of a tracker's unlocked set; the catalog refuses to grow past it
+const std::size_t MAX_ACHIEVEMENTS = 512;
+
+struct Achievement {
+    std::string key;
+    std::string name;
+    AchievementCounter counter;
+    std::int64_t threshold;
+};
+
+// Every achievement, compiled into one threshold index per counter.
+// Each index is sorted by threshold so a counter only ever has to look at
+// the next achievement it has not reached yet.
+class AchievementCatalog {
+private:
+    std::vector<Achievement> achievements;
+    std::array<std::vector<std::uint16_t>, ACHIEVEMENT_COUNTER_COUNT> thresholdIndex;
+
+    AchievementCatalog();
+    void addTiers(AchievementCounter counter, const std::vector<std::int64_t>& thresholds,
+                  const std::string& keyPrefix, const std::string& singular,
+                  const std::string& plural);
+
+public:
+    static const AchievementCatalog& instance();
+
+    const std::vector<Achievement>& all() const;
+    const Achievement& get(std::size_t id) const;
+    // Achievement ids for a counter, in ascending threshold order
+    const std::vector<std::uint16_t>& forCounter(AchievementCounter counter) const;
+    int findByKey(const std::string& key) const;
+};
+
+// Per-game achievement progress. A plain value type with no heap storage,
+// so copying GameState for snapshots stays cheap.
+class AchievementTracker {
+public:
+    AchievementTracker();
+
+    // Applies a counter delta and calls onUnlock(id) for each achievement it
+    // reaches. Only the counter's next unreached threshold is compared, so
+    // the cost is O(1) amortized no matter how large the catalog grows.
+    template <typename OnUnlock>
+    void add(AchievementCounter counter, std::int64_t delta, OnUnlock onUnlock) {
+        std::size_t c = static_cast<std::size_t>(counter);
+        counters[c] += delta;
+        advance(c, onUnlock);
+    }
+
+    // For counters that track a maximum, such as level
+    template <typename OnUnlock>
+    void raiseTo(AchievementCounter counter, std::int64_t value, OnUnlock onUnlock) {
+        std::size_t c = static_cast<std::size_t>(counter);
+        if (value > counters[c]) {
+            counters[c] = value;
+            advance(c, onUnlock);
+        }
+    }
+
+    std::int64_t get(AchievementCounter counter) const;
+    bool isUnlocked(std::size_t id) const;
+    std::size_t unlockedCount() const;
+    // Next achievement for a counter, or -1 when all of them are unlocked
+    int nextFor(AchievementCounter counter) const;
+    // Highest unlocked achievement for a counter, or -1 when none is
+    int lastFor(AchievementCounter counter) const;
+
+    // Loading: restores counters, then unlocks every threshold they reach
+    void restore(const std::array<std::int64_t, ACHIEVEMENT_COUNTER_COUNT>& values,
+                 const std::vector<std::string>& unlockedKeys);
+
+private:
+    std::array<std::int64_t, ACHIEVEMENT_COUNTER_COUNT> counters;
+    std::array<std::uint16_t, ACHIEVEMENT_COUNTER_COUNT> cursor;
+    std::bitset<MAX_ACHIEVEMENTS> unlocked;
+
+    template <typename OnUnlock>
+    void advance(std::size_t c, OnUnlock onUnlock) {
+        const auto& index = AchievementCatalog::instance().forCounter(
+            static_cast<AchievementCounter>(c));
+        while (cursor[c] < index.size() &&
+               AchievementCatalog::instance().get(index[cursor[c]]).threshold <= counters[c]) {
+            std::uint16_t id = index[cursor[c]++];
+            if (!unlocked.test(id)) {
+                unlocked.set(id);
+                onUnlock(id);
+            }
+        }
+    }
+};
+
+#endif // ACHIEVEMENTS_H
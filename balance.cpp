@@ -0,0 +1,899 @@
+#include "balance.h"
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <limits>
+
+// Built-in formulas, in BalanceFormula order. These reproduce the numbers
+// the game shipped with, including the integer truncation at each step.
+static const struct {
+    const char* name;
+    const char* source;
+} DEFAULT_FORMULAS[] = {
+    {"floor_scale", "1 + (floor - 1) * 0.2"},
+    {"enemy_health", "trunc(50 * floor_scale * difficulty)"},
+    {"enemy_attack", "trunc(8 * floor_scale * difficulty)"},
+    {"enemy_defense", "trunc(3 * floor_scale * difficulty)"},
+    {"enemy_gold", "trunc(10 * floor_scale * difficulty)"},
+    {"enemy_exp", "trunc(20 * floor_scale * difficulty)"},
+    {"boss_health", "trunc(enemy_health * 2.5)"},
+    {"boss_attack", "trunc(enemy_attack * 1.5)"},
+    {"boss_defense", "trunc(enemy_defense * 1.5)"},
+    {"boss_gold", "enemy_gold * 3"},
+    {"boss_exp", "enemy_exp * 3"},
+    {"level_health", "20"},
+    {"level_attack", "5"},
+    {"level_defense", "2"},
+    {"next_level_exp", "trunc(exp_to_next * 1.5)"},
+    {"upgrade_health", "20"},
+    {"upgrade_attack", "5"},
+    {"upgrade_defense", "2"},
+    {"upgrade_health_cost", "trunc(50 * pow(1.5, trunc(max_health / 20) - 5))"},
+    {"upgrade_attack_cost", "trunc(100 * pow(1.5, trunc(attack / 5) - 2))"},
+    {"upgrade_defense_cost", "trunc(80 * pow(1.5, trunc(defense / 2) - 2))"},
+};
+
+static_assert(sizeof(DEFAULT_FORMULAS) / sizeof(DEFAULT_FORMULAS[0]) == BALANCE_FORMULA_COUNT,
+              "every balance formula needs a default");
+
+static const char* const VAR_NAMES[] = {
+    "floor", "difficulty", "level", "exp_to_next", "max_health", "attack", "defense"
+};
+
+static_assert(sizeof(VAR_NAMES) / sizeof(VAR_NAMES[0]) == BALANCE_VAR_COUNT,
+              "every balance variable needs a name");
+
+const char* const BalanceSheet::CONFIG_FILE = "balance.cfg";
+
+// Parsed expression. Only CONST, VAR and operator opcodes appear; a node
+// naming another formula has reference >= 0 until it is inlined.
+struct FormulaNode {
+    FormulaOpcode op;
+    double value;
+    std::uint8_t var;
+    int reference;
+    std::unique_ptr<FormulaNode> left;
+    std::unique_ptr<FormulaNode> right;
+
+    FormulaNode(FormulaOpcode o) : op(o), value(0.0), var(0), reference(-1) {}
+};
+
+typedef std::unique_ptr<FormulaNode> NodePtr;
+
+static NodePtr makeConstant(double value) {
+    NodePtr node(new FormulaNode(FormulaOpcode::CONST));
+    node->value = value;
+    return node;
+}
+
+static NodePtr makeOperator(FormulaOpcode op, NodePtr left, NodePtr right = nullptr) {
+    NodePtr node(new FormulaNode(op));
+    node->left = std::move(left);
+    node->right = std::move(right);
+    return node;
+}
+
+static bool isUnary(FormulaOpcode op) {
+    return op == FormulaOpcode::NEG || op == FormulaOpcode::TRUNC || op == FormulaOpcode::FLOOR;
+}
+
+// std::trunc is a library call without SSE4.1; a round trip through a 64-bit
+// integer is one instruction each way and exact below 2^52
+static inline double truncate(double value) {
+    return std::fabs(value) < 4503599627370496.0
+        ? static_cast<double>(static_cast<long long>(value))
+        : std::trunc(value);
+}
+
+// A formula's result as an int: truncated like a cast, but saturated at the
+// int range and 0 for NaN, where the cast would be undefined
+static inline int toInt(double value) {
+    if (value > -2147483649.0 && value < 2147483648.0) {
+        return static_cast<int>(value);
+    }
+    if (std::isnan(value)) {
+        return 0;
+    }
+    return value > 0.0 ? std::numeric_limits<int>::max() : std::numeric_limits<int>::min();
+}
+
+static double applyOperator(FormulaOpcode op, double a, double b) {
+    switch (op) {
+        case FormulaOpcode::ADD: return a + b;
+        case FormulaOpcode::SUB: return a - b;
+        case FormulaOpcode::MUL: return a * b;
+        case FormulaOpcode::DIV: return a / b;
+        case FormulaOpcode::NEG: return -a;
+        case FormulaOpcode::POW: return std::pow(a, b);
+        case FormulaOpcode::TRUNC: return truncate(a);
+        case FormulaOpcode::FLOOR: return std::floor(a);
+        case FormulaOpcode::MIN: return std::min(a, b);
+        case FormulaOpcode::MAX: return std::max(a, b);
+        default: return 0.0;
+    }
+}
+
+// Recursive descent parser:
+//   expr    := term (('+' | '-') term)*
+//   term    := unary (('*' | '/') unary)*
+//   unary   := '-' unary | power
+//   power   := primary ('^' unary)?
+//   primary := number | name | function '(' args ')' | '(' expr ')'
+class FormulaParser {
+public:
+    explicit FormulaParser(const std::string& source) : text(source), pos(0) {}
+
+    NodePtr parse(std::string& error) {
+        NodePtr node = parseExpression();
+        skipSpaces();
+        if (node && pos < text.size()) {
+            fail("unexpected '" + std::string(1, text[pos]) + "'");
+        }
+        if (!message.empty()) {
+            error = message;
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    const std::string& text;
+    std::size_t pos;
+    std::string message;
+
+    NodePtr fail(const std::string& what) {
+        if (message.empty()) {
+            message = what + " at column " + std::to_string(pos + 1);
+        }
+        return nullptr;
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    NodePtr parseExpression() {
+        NodePtr left = parseTerm();
+        while (left) {
+            if (accept('+')) {
+                left = makeOperator(FormulaOpcode::ADD, std::move(left), parseTerm());
+            } else if (accept('-')) {
+                left = makeOperator(FormulaOpcode::SUB, std::move(left), parseTerm());
+            } else {
+                break;
+            }
+            if (!left->right) return nullptr;
+        }
+        return left;
+    }
+
+    NodePtr parseTerm() {
+        NodePtr left = parseUnary();
+        while (left) {
+            if (accept('*')) {
+                left = makeOperator(FormulaOpcode::MUL, std::move(left), parseUnary());
+            } else if (accept('/')) {
+                left = makeOperator(FormulaOpcode::DIV, std::move(left), parseUnary());
+            } else {
+                break;
+            }
+            if (!left->right) return nullptr;
+        }
+        return left;
+    }
+
+    NodePtr parseUnary() {
+        if (accept('-')) {
+            NodePtr operand = parseUnary();
+            return operand ? makeOperator(FormulaOpcode::NEG, std::move(operand)) : nullptr;
+        }
+        return parsePower();
+    }
+
+    NodePtr parsePower() {
+        NodePtr base = parsePrimary();
+        if (base && accept('^')) {
+            NodePtr exponent = parseUnary();
+            return exponent ? makeOperator(FormulaOpcode::POW, std::move(base), std::move(exponent))
+                            : nullptr;
+        }
+        return base;
+    }
+
+    NodePtr parsePrimary() {
+        skipSpaces();
+        if (pos >= text.size()) {
+            return fail("unexpected end of formula");
+        }
+
+        if (accept('(')) {
+            NodePtr inner = parseExpression();
+            if (inner && !accept(')')) {
+                return fail("expected ')'");
+            }
+            return inner;
+        }
+
+        char c = text[pos];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            std::size_t start = pos;
+            while (pos < text.size() &&
+                   (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.')) {
+                pos++;
+            }
+            std::istringstream number(text.substr(start, pos - start));
+            double value;
+            if (!(number >> value) || !number.eof()) {
+                pos = start;
+                return fail("bad number");
+            }
+            return makeConstant(value);
+        }
+
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::size_t start = pos;
+            while (pos < text.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) {
+                pos++;
+            }
+            std::string name = text.substr(start, pos - start);
+            if (accept('(')) {
+                return parseCall(name, start);
+            }
+
+            for (std::size_t v = 0; v < BALANCE_VAR_COUNT; v++) {
+                if (name == VAR_NAMES[v]) {
+                    NodePtr node(new FormulaNode(FormulaOpcode::VAR));
+                    node->var = static_cast<std::uint8_t>(v);
+                    return node;
+                }
+            }
+            for (std::size_t f = 0; f < BALANCE_FORMULA_COUNT; f++) {
+                if (name == DEFAULT_FORMULAS[f].name) {
+                    NodePtr node(new FormulaNode(FormulaOpcode::CONST));
+                    node->reference = static_cast<int>(f);
+                    return node;
+                }
+            }
+            pos = start;
+            return fail("unknown name '" + name + "'");
+        }
+
+        return fail("unexpected '" + std::string(1, c) + "'");
+    }
+
+    NodePtr parseCall(const std::string& name, std::size_t start) {
+        FormulaOpcode op;
+        int arity;
+        if (name == "trunc") {
+            op = FormulaOpcode::TRUNC;
+            arity = 1;
+        } else if (name == "floor") {
+            op = FormulaOpcode::FLOOR;
+            arity = 1;
+        } else if (name == "pow") {
+            op = FormulaOpcode::POW;
+            arity = 2;
+        } else if (name == "min") {
+            op = FormulaOpcode::MIN;
+            arity = 2;
+        } else if (name == "max") {
+            op = FormulaOpcode::MAX;
+            arity = 2;
+        } else {
+            pos = start;
+            return fail("unknown function '" + name + "'");
+        }
+
+        NodePtr first = parseExpression();
+        if (!first) return nullptr;
+        NodePtr second;
+        if (arity == 2) {
+            if (!accept(',')) {
+                return fail(name + "() takes two arguments");
+            }
+            second = parseExpression();
+            if (!second) return nullptr;
+        }
+        if (!accept(')')) {
+            return fail("expected ')' after " + name + "() arguments");
+        }
+        return makeOperator(op, std::move(first), std::move(second));
+    }
+};
+
+// Inlines formula references, folds constants and emits bytecode
+class FormulaCompiler {
+public:
+    explicit FormulaCompiler(const std::array<NodePtr, BALANCE_FORMULA_COUNT>& parsed)
+        : trees(parsed), active(BALANCE_FORMULA_COUNT, false) {}
+
+    bool compile(std::size_t index, CompiledFormula& out, std::string& error) {
+        active[index] = true;
+        NodePtr expanded = expand(*trees[index], error);
+        active[index] = false;
+        if (!expanded) {
+            return false;
+        }
+
+        CompiledFormula result;
+        result.code.clear();
+        result.constants.clear();
+        std::size_t maxDepth = 0;
+        if (!emit(*expanded, result, 0, maxDepth, error)) {
+            return false;
+        }
+        out = std::move(result);
+        return true;
+    }
+
+private:
+    const std::array<NodePtr, BALANCE_FORMULA_COUNT>& trees;
+    std::vector<bool> active;
+
+    static bool isConstantNode(const NodePtr& node, double value) {
+        return node && node->op == FormulaOpcode::CONST && node->value == value;
+    }
+
+    // Returns a copy of node with references inlined and constant
+    // subexpressions replaced by their value
+    NodePtr expand(const FormulaNode& node, std::string& error) {
+        if (node.reference >= 0) {
+            if (active[node.reference]) {
+                error = std::string("circular reference to ") + DEFAULT_FORMULAS[node.reference].name;
+                return nullptr;
+            }
+            active[node.reference] = true;
+            NodePtr inlined = expand(*trees[node.reference], error);
+            active[node.reference] = false;
+            return inlined;
+        }
+        if (node.op == FormulaOpcode::CONST) {
+            return makeConstant(node.value);
+        }
+        if (node.op == FormulaOpcode::VAR) {
+            NodePtr copy(new FormulaNode(FormulaOpcode::VAR));
+            copy->var = node.var;
+            return copy;
+        }
+
+        NodePtr left = expand(*node.left, error);
+        if (!left) return nullptr;
+        NodePtr right;
+        if (node.right) {
+            right = expand(*node.right, error);
+            if (!right) return nullptr;
+        }
+
+        bool leftConstant = left->op == FormulaOpcode::CONST;
+        bool rightConstant = !right || right->op == FormulaOpcode::CONST;
+        if (leftConstant && rightConstant) {
+            return makeConstant(applyOperator(node.op, left->value, right ? right->value : 0.0));
+        }
+
+        // Identities that leave the other operand's value exactly unchanged
+        switch (node.op) {
+            case FormulaOpcode::ADD:
+                if (isConstantNode(left, 0.0)) return right;
+                if (isConstantNode(right, 0.0)) return left;
+                break;
+            case FormulaOpcode::SUB:
+                if (isConstantNode(right, 0.0)) return left;
+                break;
+            case FormulaOpcode::MUL:
+                if (isConstantNode(left, 1.0)) return right;
+                if (isConstantNode(right, 1.0)) return left;
+                break;
+            case FormulaOpcode::DIV:
+                if (isConstantNode(right, 1.0)) return left;
+                break;
+            default:
+                break;
+        }
+        return makeOperator(node.op, std::move(left), std::move(right));
+    }
+
+    static bool addConstant(CompiledFormula& out, double value, std::uint8_t& index,
+                            std::string& error) {
+        for (std::size_t i = 0; i < out.constants.size(); i++) {
+            if (out.constants[i] == value) {
+                index = static_cast<std::uint8_t>(i);
+                return true;
+            }
+        }
+        if (out.constants.size() > 0xFF) {
+            error = "too many constants";
+            return false;
+        }
+        index = static_cast<std::uint8_t>(out.constants.size());
+        out.constants.push_back(value);
+        return true;
+    }
+
+    // Emits code that pushes node's value onto a stack already depth deep
+    bool emit(const FormulaNode& node, CompiledFormula& out, std::size_t depth,
+              std::size_t& maxDepth, std::string& error) {
+        if (depth + 1 > CompiledFormula::MAX_STACK_DEPTH) {
+            error = "formula nests too deeply";
+            return false;
+        }
+        maxDepth = std::max(maxDepth, depth + 1);
+
+        if (node.op == FormulaOpcode::CONST) {
+            std::uint8_t index;
+            if (!addConstant(out, node.value, index, error)) return false;
+            out.code.push_back({FormulaOpcode::CONST, index});
+            return true;
+        }
+        if (node.op == FormulaOpcode::VAR) {
+            out.code.push_back({FormulaOpcode::VAR, node.var});
+            return true;
+        }
+
+        if (isUnary(node.op)) {
+            if (!emit(*node.left, out, depth, maxDepth, error)) return false;
+            out.code.push_back({node.op, 0});
+            return true;
+        }
+
+        // IEEE addition and multiplication are commutative, so a constant
+        // on the left can move to the right without changing any result
+        const FormulaNode* left = node.left.get();
+        const FormulaNode* right = node.right.get();
+        if (left->op == FormulaOpcode::CONST &&
+            (node.op == FormulaOpcode::ADD || node.op == FormulaOpcode::MUL)) {
+            std::swap(left, right);
+        }
+        if (!emit(*left, out, depth, maxDepth, error)) return false;
+
+        // "x op constant" becomes one instruction instead of a push and an op
+        if (right->op == FormulaOpcode::CONST &&
+            (node.op == FormulaOpcode::ADD || node.op == FormulaOpcode::SUB ||
+             node.op == FormulaOpcode::MUL || node.op == FormulaOpcode::DIV)) {
+            std::uint8_t index;
+            if (!addConstant(out, right->value, index, error)) return false;
+            FormulaOpcode fused = node.op == FormulaOpcode::ADD ? FormulaOpcode::ADD_CONST
+                                : node.op == FormulaOpcode::SUB ? FormulaOpcode::SUB_CONST
+                                : node.op == FormulaOpcode::MUL ? FormulaOpcode::MUL_CONST
+                                : FormulaOpcode::DIV_CONST;
+            out.code.push_back({fused, index});
+            return true;
+        }
+
+        if (!emit(*right, out, depth + 1, maxDepth, error)) return false;
+        out.code.push_back({node.op, 0});
+        return true;
+    }
+};
+
+// An entry on the batch evaluation stack: lanes values, one per item, or
+// when lanes is null one value shared by every item, as constants and shared
+// inputs are. Shared values are never spread across lanes, so work that does
+// not vary by item runs once per block rather than once per item, and input
+// columns are read in place.
+struct BatchEntry {
+    const double* lanes;
+    double value;
+};
+
+// Each stack depth has two blocks of lanes, and an op writes the one its
+// left operand is not in, so no lane loop reads what it writes. The loops
+// run all BATCH_LANES lanes, a fixed trip count, and with the pointers known
+// not to alias they vectorize; lanes past the end of the last block are
+// discarded.
+typedef double BatchBlocks[2][CompiledFormula::BATCH_LANES];
+
+static double* freeBlock(const BatchEntry& entry, BatchBlocks& blocks) {
+    return entry.lanes == blocks[0] ? blocks[1] : blocks[0];
+}
+
+template <typename Op>
+static void laneLoop(double* __restrict out, const double* __restrict left, double right, Op op) {
+    for (std::size_t i = 0; i < CompiledFormula::BATCH_LANES; i++) out[i] = op(left[i], right);
+}
+
+template <typename Op>
+static void laneLoop(double* __restrict out, double left, const double* __restrict right, Op op) {
+    for (std::size_t i = 0; i < CompiledFormula::BATCH_LANES; i++) out[i] = op(left, right[i]);
+}
+
+template <typename Op>
+static void laneLoop(double* __restrict out, const double* __restrict left,
+                     const double* __restrict right, Op op) {
+    for (std::size_t i = 0; i < CompiledFormula::BATCH_LANES; i++) out[i] = op(left[i], right[i]);
+}
+
+template <typename Op>
+static void batchBinary(BatchEntry& left, const BatchEntry& right, BatchBlocks& blocks, Op op) {
+    if (!left.lanes && !right.lanes) {
+        left.value = op(left.value, right.value);
+        return;
+    }
+    double* out = freeBlock(left, blocks);
+    if (!right.lanes) {
+        laneLoop(out, left.lanes, right.value, op);
+    } else if (!left.lanes) {
+        laneLoop(out, left.value, right.lanes, op);
+    } else {
+        laneLoop(out, left.lanes, right.lanes, op);
+    }
+    left.lanes = out;
+}
+
+template <typename Op>
+static void batchUnary(BatchEntry& entry, BatchBlocks& blocks, Op op) {
+    if (!entry.lanes) {
+        entry.value = op(entry.value);
+        return;
+    }
+    double* out = freeBlock(entry, blocks);
+    // A unary op ignores the value on the right
+    laneLoop(out, entry.lanes, 0.0, [op](double a, double) { return op(a); });
+    entry.lanes = out;
+}
+
+// CompiledFormula implementation
+CompiledFormula::CompiledFormula() : code{{FormulaOpcode::CONST, 0}}, constants{0.0} {}
+
+double CompiledFormula::evaluate(const BalanceInputs& inputs) const {
+    // The top of the stack is kept in a register; stack holds what is below it
+    double stack[MAX_STACK_DEPTH];
+    std::size_t below = 0;
+    double top = 0.0;
+    const double* k = constants.data();
+
+    for (const FormulaInstruction& ins : code) {
+        switch (ins.opcode) {
+            case FormulaOpcode::CONST: stack[below++] = top; top = k[ins.operand]; break;
+            case FormulaOpcode::VAR: stack[below++] = top; top = inputs.values[ins.operand]; break;
+            case FormulaOpcode::ADD: top = stack[--below] + top; break;
+            case FormulaOpcode::SUB: top = stack[--below] - top; break;
+            case FormulaOpcode::MUL: top = stack[--below] * top; break;
+            case FormulaOpcode::DIV: top = stack[--below] / top; break;
+            case FormulaOpcode::ADD_CONST: top += k[ins.operand]; break;
+            case FormulaOpcode::SUB_CONST: top -= k[ins.operand]; break;
+            case FormulaOpcode::MUL_CONST: top *= k[ins.operand]; break;
+            case FormulaOpcode::DIV_CONST: top /= k[ins.operand]; break;
+            case FormulaOpcode::NEG: top = -top; break;
+            case FormulaOpcode::POW: top = std::pow(stack[--below], top); break;
+            case FormulaOpcode::TRUNC: top = truncate(top); break;
+            case FormulaOpcode::FLOOR: top = std::floor(top); break;
+            case FormulaOpcode::MIN: top = std::min(stack[--below], top); break;
+            case FormulaOpcode::MAX: top = std::max(stack[--below], top); break;
+        }
+    }
+    return top;
+}
+
+// Runs code over the block of items starting at base, lanes of them, and
+// returns the entry it leaves on the stack
+static BatchEntry evaluateBlock(const FormulaInstruction* code, const FormulaInstruction* end,
+                                const double* k, const BalanceBatch& batch, std::size_t base,
+                                std::size_t lanes, BatchBlocks* blocks) {
+    const std::size_t N = CompiledFormula::BATCH_LANES;
+    BatchEntry stack[CompiledFormula::MAX_STACK_DEPTH];
+    std::size_t top = 0;
+
+    for (const FormulaInstruction* ins = code; ins != end; ins++) {
+        switch (ins->opcode) {
+            case FormulaOpcode::CONST:
+                stack[top++] = {nullptr, k[ins->operand]};
+                break;
+            case FormulaOpcode::VAR: {
+                const double* column = batch.columns[ins->operand];
+                if (!column) {
+                    stack[top] = {nullptr, batch.shared.values[ins->operand]};
+                } else if (lanes == N) {
+                    stack[top] = {column + base, 0.0};
+                } else {
+                    // The last block is padded with zeros rather than
+                    // reading past the end of the column
+                    double* padded = blocks[top][0];
+                    std::copy(column + base, column + base + lanes, padded);
+                    std::fill(padded + lanes, padded + N, 0.0);
+                    stack[top] = {padded, 0.0};
+                }
+                top++;
+                break;
+            }
+            case FormulaOpcode::ADD:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return a + b; });
+                break;
+            case FormulaOpcode::SUB:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return a - b; });
+                break;
+            case FormulaOpcode::MUL:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return a * b; });
+                break;
+            case FormulaOpcode::DIV:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return a / b; });
+                break;
+            case FormulaOpcode::ADD_CONST:
+                batchBinary(stack[top - 1], {nullptr, k[ins->operand]}, blocks[top - 1],
+                            [](double a, double b) { return a + b; });
+                break;
+            case FormulaOpcode::SUB_CONST:
+                batchBinary(stack[top - 1], {nullptr, k[ins->operand]}, blocks[top - 1],
+                            [](double a, double b) { return a - b; });
+                break;
+            case FormulaOpcode::MUL_CONST:
+                batchBinary(stack[top - 1], {nullptr, k[ins->operand]}, blocks[top - 1],
+                            [](double a, double b) { return a * b; });
+                break;
+            case FormulaOpcode::DIV_CONST:
+                batchBinary(stack[top - 1], {nullptr, k[ins->operand]}, blocks[top - 1],
+                            [](double a, double b) { return a / b; });
+                break;
+            case FormulaOpcode::NEG:
+                batchUnary(stack[top - 1], blocks[top - 1], [](double a) { return -a; });
+                break;
+            case FormulaOpcode::POW:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return std::pow(a, b); });
+                break;
+            case FormulaOpcode::TRUNC:
+                batchUnary(stack[top - 1], blocks[top - 1], [](double a) { return truncate(a); });
+                break;
+            case FormulaOpcode::FLOOR:
+                batchUnary(stack[top - 1], blocks[top - 1], [](double a) { return std::floor(a); });
+                break;
+            case FormulaOpcode::MIN:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return std::min(a, b); });
+                break;
+            case FormulaOpcode::MAX:
+                top--;
+                batchBinary(stack[top - 1], stack[top], blocks[top - 1],
+                            [](double a, double b) { return std::max(a, b); });
+                break;
+        }
+    }
+    return stack[0];
+}
+
+void CompiledFormula::evaluateBatch(const BalanceBatch& batch, std::size_t count, double* out) const {
+    BatchBlocks blocks[MAX_STACK_DEPTH];
+    for (std::size_t base = 0; base < count; base += BATCH_LANES) {
+        const std::size_t lanes = std::min(count - base, BATCH_LANES);
+        const BatchEntry result = evaluateBlock(code.data(), code.data() + code.size(), constants.data(),
+                                                batch, base, lanes, blocks);
+        if (result.lanes) {
+            std::copy(result.lanes, result.lanes + lanes, out + base);
+        } else {
+            std::fill(out + base, out + base + lanes, result.value);
+        }
+    }
+}
+
+void CompiledFormula::evaluateBatch(const BalanceBatch& batch, std::size_t count, int* out) const {
+    // Converting truncates, so a trunc() the formula ends with need not run
+    const FormulaInstruction* end = code.data() + code.size();
+    if (code.size() > 1 && code.back().opcode == FormulaOpcode::TRUNC) {
+        end--;
+    }
+    BatchBlocks blocks[MAX_STACK_DEPTH];
+    for (std::size_t base = 0; base < count; base += BATCH_LANES) {
+        const std::size_t lanes = std::min(count - base, BATCH_LANES);
+        const BatchEntry result = evaluateBlock(code.data(), end, constants.data(), batch, base, lanes, blocks);
+        if (result.lanes) {
+            for (std::size_t i = 0; i < lanes; i++) out[base + i] = toInt(result.lanes[i]);
+        } else {
+            std::fill(out + base, out + base + lanes, toInt(result.value));
+        }
+    }
+}
+
+bool CompiledFormula::isConstant() const {
+    return code.size() == 1 && code[0].opcode == FormulaOpcode::CONST;
+}
+
+std::size_t CompiledFormula::instructionCount() const {
+    return code.size();
+}
+
+// BalanceSheet implementation
+BalanceSheet::BalanceSheet() {
+    for (std::size_t f = 0; f < BALANCE_FORMULA_COUNT; f++) {
+        sources[f] = DEFAULT_FORMULAS[f].source;
+    }
+    std::istringstream none;
+    std::string error;
+    load(none, error);
+}
+
+static std::string& loadErrorStorage() {
+    static std::string error;
+    return error;
+}
+
+const BalanceSheet& BalanceSheet::instance() {
+    static const BalanceSheet sheet = [] {
+        BalanceSheet loaded;
+        std::ifstream file(CONFIG_FILE);
+        if (file.is_open()) {
+            loaded.load(file, loadErrorStorage());
+        }
+        return loaded;
+    }();
+    return sheet;
+}
+
+const std::string& BalanceSheet::configError() {
+    instance();
+    return loadErrorStorage();
+}
+
+static std::string trim(const std::string& text) {
+    std::size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos) {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+bool BalanceSheet::load(std::istream& in, std::string& error) {
+    std::array<std::string, BALANCE_FORMULA_COUNT> updated = sources;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = "line " + std::to_string(lineNumber) + ": expected 'name = formula'";
+            return false;
+        }
+        std::string name = trim(line.substr(0, equals));
+        std::size_t f = 0;
+        while (f < BALANCE_FORMULA_COUNT && name != DEFAULT_FORMULAS[f].name) {
+            f++;
+        }
+        if (f == BALANCE_FORMULA_COUNT) {
+            error = "line " + std::to_string(lineNumber) + ": unknown formula '" + name + "'";
+            return false;
+        }
+        updated[f] = trim(line.substr(equals + 1));
+    }
+
+    // Parse everything first so references can be inlined in any order
+    std::array<NodePtr, BALANCE_FORMULA_COUNT> parsed;
+    for (std::size_t f = 0; f < BALANCE_FORMULA_COUNT; f++) {
+        std::string parseError;
+        parsed[f] = FormulaParser(updated[f]).parse(parseError);
+        if (!parsed[f]) {
+            error = std::string(DEFAULT_FORMULAS[f].name) + ": " + parseError;
+            return false;
+        }
+    }
+
+    std::array<CompiledFormula, BALANCE_FORMULA_COUNT> result;
+    FormulaCompiler compiler(parsed);
+    for (std::size_t f = 0; f < BALANCE_FORMULA_COUNT; f++) {
+        std::string compileError;
+        if (!compiler.compile(f, result[f], compileError)) {
+            error = std::string(DEFAULT_FORMULAS[f].name) + ": " + compileError;
+            return false;
+        }
+    }
+
+    sources = updated;
+    compiled = std::move(result);
+    return true;
+}
+
+bool BalanceSheet::loadFile(const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        error = "could not open " + filename;
+        return false;
+    }
+    return load(file, error);
+}
+
+const CompiledFormula& BalanceSheet::formula(BalanceFormula which) const {
+    return compiled[static_cast<std::size_t>(which)];
+}
+
+const std::string& BalanceSheet::source(BalanceFormula which) const {
+    return sources[static_cast<std::size_t>(which)];
+}
+
+double BalanceSheet::evaluate(BalanceFormula which, const BalanceInputs& inputs) const {
+    return compiled[static_cast<std::size_t>(which)].evaluate(inputs);
+}
+
+int BalanceSheet::evaluateInt(BalanceFormula which, const BalanceInputs& inputs) const {
+    return toInt(evaluate(which, inputs));
+}
+
+std::vector<EnemyScaling> BalanceSheet::evaluateFloorScaling(int floorCount, double difficulty) const {
+    const std::size_t count = static_cast<std::size_t>(std::max(0, floorCount));
+    const std::size_t N = CompiledFormula::BATCH_LANES;
+    double floorNumbers[N];
+    BalanceBatch batch;
+    batch.setColumn(BalanceVar::FLOOR, floorNumbers);
+    batch.shared[BalanceVar::DIFFICULTY] = difficulty;
+
+    // A block of floors at a time, one batch pass per stat, so the columns
+    // stay in cache between the passes and the gathering into floors
+    static const BalanceFormula columns[] = {
+        BalanceFormula::ENEMY_HEALTH, BalanceFormula::ENEMY_ATTACK, BalanceFormula::ENEMY_DEFENSE,
+        BalanceFormula::ENEMY_GOLD, BalanceFormula::ENEMY_EXP
+    };
+    int values[5][N];
+    std::vector<EnemyScaling> floors;
+    floors.reserve(count);
+    for (std::size_t base = 0; base < count; base += N) {
+        const std::size_t lanes = std::min(count - base, N);
+        for (std::size_t i = 0; i < lanes; i++) {
+            floorNumbers[i] = static_cast<double>(base + i + 1);
+        }
+        for (std::size_t c = 0; c < 5; c++) {
+            formula(columns[c]).evaluateBatch(batch, lanes, values[c]);
+        }
+        for (std::size_t i = 0; i < lanes; i++) {
+            floors.push_back({values[0][i], values[1][i], values[2][i], values[3][i], values[4][i]});
+        }
+    }
+    return floors;
+}
+
+EnemyScaling BalanceSheet::evaluateEnemyScaling(int floor, double difficulty, bool boss) const {
+    BalanceInputs inputs;
+    inputs[BalanceVar::FLOOR] = floor;
+    inputs[BalanceVar::DIFFICULTY] = difficulty;
+    if (boss) {
+        return {evaluateInt(BalanceFormula::BOSS_HEALTH, inputs),
+                evaluateInt(BalanceFormula::BOSS_ATTACK, inputs),
+                evaluateInt(BalanceFormula::BOSS_DEFENSE, inputs),
+                evaluateInt(BalanceFormula::BOSS_GOLD, inputs),
+                evaluateInt(BalanceFormula::BOSS_EXP, inputs)};
+    }
+    return {evaluateInt(BalanceFormula::ENEMY_HEALTH, inputs),
+            evaluateInt(BalanceFormula::ENEMY_ATTACK, inputs),
+            evaluateInt(BalanceFormula::ENEMY_DEFENSE, inputs),
+            evaluateInt(BalanceFormula::ENEMY_GOLD, inputs),
+            evaluateInt(BalanceFormula::ENEMY_EXP, inputs)};
+}
+
+const char* BalanceSheet::formulaName(BalanceFormula which) {
+    return DEFAULT_FORMULAS[static_cast<std::size_t>(which)].name;
+}
+
+const char* BalanceSheet::varName(BalanceVar var) {
+    return VAR_NAMES[static_cast<std::size_t>(var)];
+}
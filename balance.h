@@ -0,0 +1,168 @@
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <iosfwd>
+#include <cstdint>
+#include <cstddef>
+
+// Inputs a formula can read. Names in the config file are in BalanceSheet.
+enum class BalanceVar : std::uint8_t {
+    FLOOR,
+    DIFFICULTY,
+    LEVEL,
+    EXP_TO_NEXT,
+    MAX_HEALTH,
+    ATTACK,
+    DEFENSE,
+    COUNT
+};
+
+// Every tunable curve. Formulas may reference earlier or later ones by name;
+// references are inlined when the sheet is compiled.
+enum class BalanceFormula : std::uint8_t {
+    FLOOR_SCALE,
+    ENEMY_HEALTH,
+    ENEMY_ATTACK,
+    ENEMY_DEFENSE,
+    ENEMY_GOLD,
+    ENEMY_EXP,
+    BOSS_HEALTH,
+    BOSS_ATTACK,
+    BOSS_DEFENSE,
+    BOSS_GOLD,
+    BOSS_EXP,
+    LEVEL_HEALTH,
+    LEVEL_ATTACK,
+    LEVEL_DEFENSE,
+    NEXT_LEVEL_EXP,
+    UPGRADE_HEALTH,
+    UPGRADE_ATTACK,
+    UPGRADE_DEFENSE,
+    UPGRADE_HEALTH_COST,
+    UPGRADE_ATTACK_COST,
+    UPGRADE_DEFENSE_COST,
+    COUNT
+};
+
+const std::size_t BALANCE_VAR_COUNT = static_cast<std::size_t>(BalanceVar::COUNT);
+const std::size_t BALANCE_FORMULA_COUNT = static_cast<std::size_t>(BalanceFormula::COUNT);
+
+struct BalanceInputs {
+    std::array<double, BALANCE_VAR_COUNT> values;
+
+    BalanceInputs() { values.fill(0.0); }
+    double& operator[](BalanceVar var) { return values[static_cast<std::size_t>(var)]; }
+    double operator[](BalanceVar var) const { return values[static_cast<std::size_t>(var)]; }
+};
+
+// Inputs for batch evaluation: each variable is either a column with one
+// value per item or, when its column is null, the value in shared
+struct BalanceBatch {
+    std::array<const double*, BALANCE_VAR_COUNT> columns;
+    BalanceInputs shared;
+
+    BalanceBatch() { columns.fill(nullptr); }
+    void setColumn(BalanceVar var, const double* values) { columns[static_cast<std::size_t>(var)] = values; }
+};
+
+enum class FormulaOpcode : std::uint8_t {
+    CONST,      // push constants[operand]
+    VAR,        // push inputs[operand]
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    ADD_CONST,  // top op= constants[operand], saving a push for the common case
+    SUB_CONST,
+    MUL_CONST,
+    DIV_CONST,
+    NEG,
+    POW,
+    TRUNC,
+    FLOOR,
+    MIN,
+    MAX
+};
+
+struct FormulaInstruction {
+    FormulaOpcode opcode;
+    std::uint8_t operand;
+};
+
+// A formula compiled to stack bytecode. Constant subexpressions are folded
+// at compile time, so only work that depends on the inputs is left.
+class CompiledFormula {
+public:
+    static const std::size_t MAX_STACK_DEPTH = 16;
+    static const std::size_t BATCH_LANES = 64;
+
+    CompiledFormula();
+
+    double evaluate(const BalanceInputs& inputs) const;
+    // Evaluates count items. Each instruction is dispatched once per block
+    // of BATCH_LANES items and runs as a tight loop over the block.
+    void evaluateBatch(const BalanceBatch& batch, std::size_t count, double* out) const;
+    // Converts each result as BalanceSheet::evaluateInt() does
+    void evaluateBatch(const BalanceBatch& batch, std::size_t count, int* out) const;
+
+    bool isConstant() const;
+    std::size_t instructionCount() const;
+
+private:
+    friend class FormulaCompiler;
+
+    std::vector<FormulaInstruction> code;
+    std::vector<double> constants;
+};
+
+// Enemy stats for one floor, converted as by evaluateInt()
+struct EnemyScaling {
+    int health;
+    int attack;
+    int defense;
+    int gold;
+    int exp;
+};
+
+// The game's scaling curves, read from a config file of "name = expression"
+// lines and compiled once at startup. Formulas missing from the file keep
+// their built-in defaults, which match the original hard-coded numbers.
+class BalanceSheet {
+public:
+    static const char* const CONFIG_FILE;
+
+    // Compiled built-in defaults
+    BalanceSheet();
+
+    // The sheet the game uses: CONFIG_FILE if it exists and compiles,
+    // otherwise the defaults
+    static const BalanceSheet& instance();
+    // Why CONFIG_FILE was rejected, or empty if it loaded or does not exist
+    static const std::string& configError();
+
+    // All-or-nothing: on error the sheet is unchanged and error says why
+    bool load(std::istream& in, std::string& error);
+    bool loadFile(const std::string& filename, std::string& error);
+
+    const CompiledFormula& formula(BalanceFormula which) const;
+    const std::string& source(BalanceFormula which) const;
+    double evaluate(BalanceFormula which, const BalanceInputs& inputs) const;
+    // Truncated toward zero and saturated at the int range; NaN gives 0
+    int evaluateInt(BalanceFormula which, const BalanceInputs& inputs) const;
+
+    // Regular enemies on floors 1..floorCount, evaluated as one batch
+    std::vector<EnemyScaling> evaluateFloorScaling(int floorCount, double difficulty) const;
+    EnemyScaling evaluateEnemyScaling(int floor, double difficulty, bool boss) const;
+
+    static const char* formulaName(BalanceFormula which);
+    static const char* varName(BalanceVar var);
+
+private:
+    std::array<std::string, BALANCE_FORMULA_COUNT> sources;
+    std::array<CompiledFormula, BALANCE_FORMULA_COUNT> compiled;
+};
+
+#endif // BALANCE_H
@@ -0,0 +1,659 @@
+// Performance benchmarks for the game systems.
+// Build and run with: make bench
+#include "game.h"
+#include "save_slots.h"
+#include "farming.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <sstream>
+#include <filesystem>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <thread>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+// Counts heap allocations so benchmarks can check allocation-free paths
+static std::size_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Average wall time of fn in milliseconds over the given iterations
+template <typename Fn>
+static double measureMs(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+static bool report(const std::string& name, double value, double target, const std::string& unit) {
+    bool pass = value <= target;
+    std::cout << "  " << (pass ? "✅ " : "❌ ") << std::left << std::setw(36) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << value
+              << " " << unit << "  (target <= " << target << " " << unit << ")\n";
+    return pass;
+}
+
+static bool benchSaveSlots() {
+    printHeader("Save slots");
+    const std::string dir = "bench_saves";
+    fs::remove_all(dir);
+
+    GameState game;
+    SaveSlotManager slots(dir);
+    const int slotCount = 8;
+    const int snapshotsPerSlot = SaveSlotManager::MAX_SNAPSHOTS;
+
+    // Fill every slot to its history limit with slowly changing saves
+    for (int s = 0; s < slotCount; s++) {
+        for (int i = 0; i < snapshotsPerSlot; i++) {
+            game.getPlayer().gold += 37;
+            game.getPlayer().floorsCleared++;
+            if (i % 10 == 0) {
+                game.getPlayer().gainExperience(150);
+            }
+            slots.saveSnapshot("slot" + std::to_string(s), game);
+        }
+    }
+
+    std::ostringstream full;
+    game.writeSave(full);
+    std::uintmax_t historyBytes = fs::file_size(dir + "/slot0.hist");
+    std::uintmax_t fullBytes = full.str().size() * snapshotsPerSlot;
+    std::cout << "  History for " << snapshotsPerSlot << " snapshots: " << historyBytes
+              << " bytes (" << fullBytes << " bytes as full saves)\n";
+
+    bool ok = true;
+    ok &= report("history size vs full saves", 100.0 * historyBytes / fullBytes, 50.0, "%");
+
+    double listMs = measureMs(200, [&](int) {
+        SaveSlotManager reopened(dir);
+        volatile size_t count = reopened.listSlots().size();
+        (void)count;
+    });
+    ok &= report("list slots (cold index read)", listMs, 1.0, "ms");
+
+    double loadMs = measureMs(500, [&](int i) {
+        GameState loaded;
+        slots.loadSnapshot("slot" + std::to_string(i % slotCount), (i * 37) % snapshotsPerSlot, loaded);
+    });
+    ok &= report("load historical snapshot", loadMs, 5.0, "ms");
+
+    double saveMs = measureMs(200, [&](int i) {
+        game.getPlayer().gold += 11;
+        slots.saveSnapshot("slot" + std::to_string(i % slotCount), game);
+    });
+    ok &= report("create snapshot (full history)", saveMs, 10.0, "ms");
+
+    // Same history with a full inventory, a drop and a salvage between saves
+    std::mt19937 rng(7);
+    GameState hoarder;
+    std::vector<Item> hoard;
+    for (std::size_t i = 0; i < Inventory::MAX_ITEMS; i++) {
+        hoard.push_back(generateItem(1 + static_cast<int>(i % 150), i % 20 == 0, rng));
+    }
+    hoarder.editInventory().addAll(hoard);
+    hoarder.equipBest(GearRank::POWER);
+    auto churn = [&](int i) {
+        Inventory& items = hoarder.editInventory();
+        std::uint32_t id = static_cast<std::uint32_t>((i * 7919) % Inventory::MAX_ITEMS);
+        if (items.salvage(id) > 0) {
+            items.add(generateItem(1 + i % 150, false, rng));
+        }
+        hoarder.getPlayer().gold += 11;
+    };
+    for (int i = 0; i < snapshotsPerSlot; i++) {
+        churn(i);
+        slots.saveSnapshot("hoard", hoarder);
+    }
+
+    std::ostringstream hoardSave;
+    hoarder.writeSave(hoardSave);
+    std::cout << "  Full inventory save: " << hoardSave.str().size() << " bytes for "
+              << hoarder.getInventory().size() << " items\n";
+    ok &= report("full save size per item",
+                 static_cast<double>(hoardSave.str().size()) / hoarder.getInventory().size(), 12.0, "bytes");
+
+    double hoardLoadMs = measureMs(20, [&](int i) {
+        GameState loaded;
+        slots.loadSnapshot("hoard", (i * 37) % snapshotsPerSlot, loaded);
+    });
+    ok &= report("load snapshot (full inventory)", hoardLoadMs, 5.0, "ms");
+
+    // A load leaves the rankings to the first call that needs them
+    double rankMs = 0.0;
+    for (int i = 0; i < 20; i++) {
+        GameState loaded;
+        slots.loadSnapshot("hoard", (i * 37) % snapshotsPerSlot, loaded);
+        rankMs += measureMs(1, [&](int) { loaded.equipBest(GearRank::ATTACK); }) / 20;
+    }
+    ok &= report("first equip-best after a load", rankMs, 6.0, "ms");
+
+    double hoardSaveMs = measureMs(20, [&](int i) {
+        churn(snapshotsPerSlot + i);
+        slots.saveSnapshot("hoard", hoarder);
+    });
+    ok &= report("create snapshot (full inventory)", hoardSaveMs, 10.0, "ms");
+
+    fs::remove_all(dir);
+    return ok;
+}
+
+static bool benchSnapshots() {
+    printHeader("GameState snapshots");
+    GameState game;
+    game.startDungeon(Biome::FOREST, DungeonSize::MEDIUM);
+
+    bool ok = true;
+    const int iterations = 200000;
+    StateHistory history(20);
+    std::size_t before = allocationCount;
+    double snapshotMs = measureMs(iterations, [&](int) { history.record(game); });
+    double allocations = static_cast<double>(allocationCount - before) / iterations;
+    ok &= report("record snapshot", snapshotMs * 1e6, 200.0, "ns");
+    ok &= report("allocations per snapshot", allocations, 0.0, "allocs");
+
+    // A fork shares the enemy until it attacks; the original must not change
+    GameState fork = game;
+    int enemyHealth = game.getCurrentEnemy()->health;
+    fork.attackEnemy();
+    ok &= report("fork mutations leaking to original",
+                 game.getCurrentEnemy()->health != enemyHealth ? 1.0 : 0.0, 0.0, "errors");
+
+    double previewMs = measureMs(20, [&](int) {
+        GameState upgraded = game;
+        upgraded.getPlayer().gold += upgraded.getUpgradeCost("attack");
+        upgraded.upgradeStat("attack");
+        upgraded.projectRun(Biome::FOREST, DungeonSize::MEDIUM, 20);
+    });
+    ok &= report("upgrade preview (20 simulated runs)", previewMs, 20.0, "ms");
+    return ok;
+}
+
+// Auto-battles count full dungeon runs and returns the number of exchanges
+static long long runDungeons(GameState& game, Biome biome, DungeonSize size, int runs) {
+    long long exchanges = 0;
+    for (int i = 0; i < runs; i++) {
+        game.startDungeon(biome, size);
+        while (game.isInDungeon()) {
+            game.attackEnemy();
+            exchanges++;
+        }
+    }
+    return exchanges;
+}
+
+static bool benchCombatLog() {
+    printHeader("Combat log");
+    bool ok = true;
+
+    CombatLog log;
+    double recordMs = measureMs(1000000, [&](int i) {
+        log.record(CombatEventKind::PLAYER_HIT, 0, i & 63, i, i >> 1);
+    });
+    ok &= report("record event", recordMs * 1e6, 10.0, "ns");
+    ok &= report("bytes per event", static_cast<double>(sizeof(CombatEvent)), 16.0, "bytes");
+
+    // Same auto-battle workload with and without a log attached
+    GameState hero;
+    hero.getPlayer().attack = 60;
+    hero.getPlayer().defense = 40;
+    hero.getPlayer().maxHealth = 2000;
+    hero.getPlayer().recalculateStats();
+    const int runs = 2000;
+
+    // Start with a full inventory so both runs see the same steady-state drops
+    std::mt19937 rng(99);
+    while (!hero.getInventory().isFull()) {
+        hero.editInventory().add(generateItem(10, false, rng));
+    }
+
+    // Every measured run starts from a fresh O(1) copy of the same hero, and
+    // the two variants alternate so machine noise hits both alike
+    long long exchanges = 0;
+    double plainMs = 1e9;
+    double loggedMs = 1e9;
+    for (int repeat = 0; repeat < 9; repeat++) {
+        plainMs = std::min(plainMs, measureMs(1, [&](int) {
+            GameState plain = hero;
+            exchanges = runDungeons(plain, Biome::FOREST, DungeonSize::EPIC, runs);
+        }));
+        loggedMs = std::min(loggedMs, measureMs(1, [&](int) {
+            GameState logged = hero;
+            logged.setCombatLog(&log);
+            runDungeons(logged, Biome::FOREST, DungeonSize::EPIC, runs);
+        }));
+    }
+
+    std::cout << "  " << exchanges << " exchanges: " << plainMs << " ms plain, "
+              << loggedMs << " ms logged\n";
+    ok &= report("logging overhead in auto-battle", 100.0 * (loggedMs - plainMs) / plainMs, 15.0, "%");
+    return ok;
+}
+
+static bool benchAchievements() {
+    printHeader("Achievements");
+    bool ok = true;
+
+    // Every update only compares against the counter's next threshold
+    AchievementTracker tracker;
+    std::size_t unlocks = 0;
+    const int iterations = 5000000;
+    double updateMs = measureMs(iterations, [&](int i) {
+        tracker.add(static_cast<AchievementCounter>(i % ACHIEVEMENT_COUNTER_COUNT), 7,
+                    [&](std::uint16_t) { unlocks++; });
+    });
+    std::cout << "  " << AchievementCatalog::instance().all().size() << " achievements, "
+              << unlocks << " unlocked during the run\n";
+    ok &= report("counter delta with unlock check", updateMs * 1e6, 10.0, "ns");
+    return ok;
+}
+
+static bool benchInventory() {
+    printHeader("Inventory");
+    bool ok = true;
+    std::mt19937 rng(1234);
+
+    std::vector<Item> drops;
+    for (std::size_t i = 0; i < Inventory::MAX_ITEMS; i++) {
+        drops.push_back(generateItem(1 + static_cast<int>(i % 150), i % 20 == 0, rng));
+    }
+
+    GameState game;
+    Inventory& items = game.editInventory();
+    double addMs = measureMs(static_cast<int>(drops.size()), [&](int i) { items.add(drops[i]); });
+    std::cout << "  " << items.size() << " items, " << sizeof(Item) << " bytes each in the pool\n";
+    ok &= report("add item", addMs * 1e6, 800.0, "ns");
+
+    double equipMs = measureMs(1000, [&](int i) {
+        game.equipBest(i % 2 ? GearRank::ATTACK : GearRank::DEFENSE);
+    });
+    ok &= report("equip best for a stat (full inventory)", equipMs * 1000.0, 3.0, "us");
+
+    game.equipBest(GearRank::POWER);
+    std::size_t before = items.size();
+    double salvageMs = measureMs(1, [&](int) { game.salvageWorseItems(GearRank::POWER); });
+    std::cout << "  Auto-salvage removed " << (before - items.size()) << " items\n";
+    ok &= report("auto-salvage everything worse", salvageMs, 5.0, "ms");
+
+    // The combat menu records a rewind snapshot before every attack, so each
+    // drop lands in an inventory a snapshot still shares
+    GameState hoard;
+    hoard.getPlayer().attack = 60;
+    hoard.getPlayer().defense = 40;
+    hoard.getPlayer().maxHealth = 2000;
+    hoard.getPlayer().recalculateStats();
+    const std::size_t hoardSize = 30000;
+    for (std::size_t i = 0; i < hoardSize; i++) {
+        hoard.editInventory().add(drops[i]);
+    }
+    StateHistory history(20);
+    double dropMs = measureMs(2000, [&](int i) {
+        history.record(hoard);
+        hoard.editInventory().add(drops[hoardSize + i]);
+    });
+    ok &= report("record + drop (30k items)", dropMs * 1000.0, 20.0, "us");
+
+    long long exchanges = 0;
+    double plainMs = 1e9;
+    double recordedMs = 1e9;
+    for (int repeat = 0; repeat < 5; repeat++) {
+        plainMs = std::min(plainMs, measureMs(1, [&](int) {
+            GameState plain = hoard;
+            exchanges = runDungeons(plain, Biome::FOREST, DungeonSize::EPIC, 50);
+        }));
+        recordedMs = std::min(recordedMs, measureMs(1, [&](int) {
+            GameState recorded = hoard;
+            for (int run = 0; run < 50; run++) {
+                recorded.startDungeon(Biome::FOREST, DungeonSize::EPIC);
+                while (recorded.isInDungeon()) {
+                    history.record(recorded);
+                    recorded.attackEnemy();
+                }
+            }
+        }));
+    }
+    std::cout << "  " << exchanges << " exchanges: " << plainMs << " ms plain, "
+              << recordedMs << " ms recording each attack\n";
+    ok &= report("record + attack (30k items)", recordedMs * 1e6 / exchanges, 500.0, "ns");
+    return ok;
+}
+
+// The scaling code the balance formulas replaced, kept as the reference
+// for both correctness and speed
+static EnemyScaling hardCodedEnemy(int floor, double difficulty, bool boss) {
+    double floorMultiplier = 1.0 + (floor - 1) * 0.2;
+    EnemyScaling stats = {static_cast<int>(50 * floorMultiplier * difficulty),
+                          static_cast<int>(8 * floorMultiplier * difficulty),
+                          static_cast<int>(3 * floorMultiplier * difficulty),
+                          static_cast<int>(10 * floorMultiplier * difficulty),
+                          static_cast<int>(20 * floorMultiplier * difficulty)};
+    if (boss) {
+        stats.health = static_cast<int>(stats.health * 2.5);
+        stats.attack = static_cast<int>(stats.attack * 1.5);
+        stats.defense = static_cast<int>(stats.defense * 1.5);
+        stats.gold = stats.gold * 3;
+        stats.exp = stats.exp * 3;
+    }
+    return stats;
+}
+
+static int hardCodedUpgradeCost(const Player& player) {
+    return static_cast<int>(50 * std::pow(1.5, player.maxHealth / 20 - 5)) +
+           static_cast<int>(100 * std::pow(1.5, player.attack / 5 - 2)) +
+           static_cast<int>(80 * std::pow(1.5, player.defense / 2 - 2));
+}
+
+static bool sameScaling(const EnemyScaling& a, const EnemyScaling& b) {
+    return a.health == b.health && a.attack == b.attack && a.defense == b.defense &&
+           a.gold == b.gold && a.exp == b.exp;
+}
+
+static bool benchBalance() {
+    printHeader("Balance formulas");
+    bool ok = true;
+    BalanceSheet balance;
+    const double difficulties[] = {1.0, 1.5, 2.0, 3.0};
+    const int floorCount = 1000;
+
+    // The default formulas must reproduce the hard-coded numbers exactly
+    int mismatches = 0;
+    for (double difficulty : difficulties) {
+        std::vector<EnemyScaling> batch = balance.evaluateFloorScaling(floorCount, difficulty);
+        for (int floor = 1; floor <= floorCount; floor++) {
+            EnemyScaling expected = hardCodedEnemy(floor, difficulty, false);
+            mismatches += !sameScaling(batch[floor - 1], expected);
+            mismatches += !sameScaling(balance.evaluateEnemyScaling(floor, difficulty, false), expected);
+            mismatches += !sameScaling(balance.evaluateEnemyScaling(floor, difficulty, true),
+                                       hardCodedEnemy(floor, difficulty, true));
+        }
+    }
+
+    Player leveled;
+    int level = 1, maxHealth = 100, attack = 10, defense = 5, expToNext = 100;
+    for (int i = 0; i < 40; i++) {
+        leveled.gainExperience(leveled.expToNextLevel);
+        level++;
+        maxHealth += 20;
+        attack += 5;
+        defense += 2;
+        expToNext = static_cast<int>(expToNext * 1.5);
+        mismatches += leveled.level != level || leveled.maxHealth != maxHealth ||
+                      leveled.attack != attack || leveled.defense != defense ||
+                      leveled.expToNextLevel != expToNext;
+    }
+
+    // Stats up to where the costs still fit an int; past that the formulas
+    // saturate and the hard-coded casts are undefined
+    std::vector<Player> shoppers(500);
+    for (std::size_t i = 0; i < shoppers.size(); i++) {
+        const int step = static_cast<int>(i);
+        shoppers[i].maxHealth = 60 + step % 100 * 8;
+        shoppers[i].attack = 1 + step % 70 * 3;
+        shoppers[i].defense = step % 89;
+    }
+    auto formulaUpgradeCost = [&](const Player& player) {
+        BalanceInputs inputs = player.balanceInputs();
+        return balance.evaluateInt(BalanceFormula::UPGRADE_HEALTH_COST, inputs) +
+               balance.evaluateInt(BalanceFormula::UPGRADE_ATTACK_COST, inputs) +
+               balance.evaluateInt(BalanceFormula::UPGRADE_DEFENSE_COST, inputs);
+    };
+    for (const Player& shopper : shoppers) {
+        mismatches += formulaUpgradeCost(shopper) != hardCodedUpgradeCost(shopper);
+    }
+    Player hoarder;
+    hoarder.defense = 1000;
+    mismatches += balance.evaluateInt(BalanceFormula::UPGRADE_DEFENSE_COST, hoarder.balanceInputs()) !=
+                  std::numeric_limits<int>::max();
+    ok &= report("results differing from hard-coded", mismatches, 0.0, "errors");
+
+    std::size_t instructions = 0;
+    for (std::size_t f = 0; f < BALANCE_FORMULA_COUNT; f++) {
+        instructions += balance.formula(static_cast<BalanceFormula>(f)).instructionCount();
+    }
+    std::cout << "  " << BALANCE_FORMULA_COUNT << " formulas compiled to " << instructions
+              << " instructions\n";
+
+    // Formulas one floor at a time and a batch of floors against the same
+    // stats hard-coded, and the upgrade cost queries the planner makes. The
+    // simulator reads enemy stats from tables batch-evaluated at startup, so
+    // its lookups are timed as well. Variants are interleaved and best-of so
+    // machine noise hits them alike.
+    std::vector<EnemyScaling> table = balance.evaluateFloorScaling(floorCount, 1.5);
+    volatile long long sink = 0;
+    double hardFloorsMs = 1e9, lookupFloorsMs = 1e9, batchFloorsMs = 1e9, scalarFloorsMs = 1e9;
+    double hardCostMs = 1e9, formulaCostMs = 1e9;
+    for (int repeat = 0; repeat < 5; repeat++) {
+        hardFloorsMs = std::min(hardFloorsMs, measureMs(200, [&](int i) {
+            long long total = 0;
+            for (int floor = 1; floor <= floorCount; floor++) {
+                EnemyScaling stats = hardCodedEnemy(floor, difficulties[i & 3], false);
+                total += stats.health + stats.attack + stats.defense + stats.gold + stats.exp;
+            }
+            sink = sink + total;
+        }));
+        scalarFloorsMs = std::min(scalarFloorsMs, measureMs(200, [&](int i) {
+            long long total = 0;
+            for (int floor = 1; floor <= floorCount; floor++) {
+                EnemyScaling stats = balance.evaluateEnemyScaling(floor, difficulties[i & 3], false);
+                total += stats.health + stats.attack + stats.defense + stats.gold + stats.exp;
+            }
+            sink = sink + total;
+        }));
+        batchFloorsMs = std::min(batchFloorsMs, measureMs(200, [&](int i) {
+            long long total = 0;
+            for (const EnemyScaling& stats : balance.evaluateFloorScaling(floorCount, difficulties[i & 3])) {
+                total += stats.health + stats.attack + stats.defense + stats.gold + stats.exp;
+            }
+            sink = sink + total;
+        }));
+        lookupFloorsMs = std::min(lookupFloorsMs, measureMs(200, [&](int) {
+            long long total = 0;
+            for (int floor = 1; floor <= floorCount; floor++) {
+                const EnemyScaling& stats = table[floor - 1];
+                total += stats.health + stats.attack + stats.defense + stats.gold + stats.exp;
+            }
+            sink = sink + total;
+        }));
+        hardCostMs = std::min(hardCostMs, measureMs(200, [&](int) {
+            long long total = 0;
+            for (const Player& shopper : shoppers) total += hardCodedUpgradeCost(shopper);
+            sink = sink + total;
+        }));
+        formulaCostMs = std::min(formulaCostMs, measureMs(200, [&](int) {
+            long long total = 0;
+            for (const Player& shopper : shoppers) total += formulaUpgradeCost(shopper);
+            sink = sink + total;
+        }));
+    }
+
+    std::cout << "  Stats for " << floorCount << " floors: " << hardFloorsMs * 1000.0 << " us hard-coded, "
+              << scalarFloorsMs * 1000.0 << " us scalar, " << batchFloorsMs * 1000.0 << " us batch, "
+              << lookupFloorsMs * 1000.0 << " us table\n";
+    std::cout << "  Upgrade costs: " << hardCostMs * 1e6 / shoppers.size() << " ns hard-coded, "
+              << formulaCostMs * 1e6 / shoppers.size() << " ns from formulas\n";
+    ok &= report("scalar enemy stats vs hard-coded", scalarFloorsMs / hardFloorsMs, 2.0, "x");
+    ok &= report("batch enemy stats vs hard-coded", batchFloorsMs / hardFloorsMs, 2.0, "x");
+    ok &= report("simulator stats table vs hard-coded", lookupFloorsMs / hardFloorsMs, 2.0, "x");
+    ok &= report("planner upgrade cost vs hard-coded", formulaCostMs / hardCostMs, 2.0, "x");
+    return ok;
+}
+
+static bool benchFarming() {
+    printHeader("Farming Queue");
+    bool ok = true;
+    const int runs = 200;
+    const FarmEntry entry = {Biome::FOREST, DungeonSize::SMALL, FarmGoal::RUNS, runs, UpgradeRule::NONE, false};
+
+    // Unpaced scheduler against the bare exchange loop, per exchange since
+    // runs vary in length. Alternated, best of five.
+    FarmingScheduler farming;
+    farming.queue().push_back(entry);
+    double bestRaw = 1e9;
+    double bestScheduled = 1e9;
+    FarmingReport unpaced = {};
+    for (int round = 0; round < 5; round++) {
+        GameState raw;
+        long long rawExchanges = 0;
+        double rawMs = measureMs(1, [&](int) { rawExchanges = runDungeons(raw, entry.biome, entry.size, runs); });
+        bestRaw = std::min(bestRaw, rawMs / rawExchanges);
+
+        GameState scheduled;
+        double scheduledMs = measureMs(1, [&](int) { unpaced = farming.run(scheduled, 0.0); });
+        bestScheduled = std::min(bestScheduled, scheduledMs / unpaced.exchanges);
+    }
+    std::cout << "  " << std::fixed << std::setprecision(0) << unpaced.runsPerSimHour()
+              << " runs/hour in game, " << unpaced.runsPerWallHour() << " runs/hour unpaced\n";
+    ok &= report("scheduler overhead vs bare loop", bestScheduled / bestRaw, 1.10, "x");
+
+    // Paced: wall time should track simulated time / speed
+    const double speed = 2000.0;
+    FarmingScheduler paced;
+    paced.queue().push_back({Biome::FOREST, DungeonSize::SMALL, FarmGoal::RUNS, 40, UpgradeRule::NONE, false});
+    GameState pacedGame;
+    FarmingReport pacedReport = paced.run(pacedGame, speed);
+    double expected = pacedReport.simSeconds / speed;
+    std::cout << "  " << std::setprecision(1) << pacedReport.simSeconds << " s simulated at " << speed
+              << "x in " << std::setprecision(3) << pacedReport.wallSeconds << " s\n";
+    ok &= report("pacing error at 2000x", std::abs(pacedReport.wallSeconds - expected) / expected * 100.0,
+                 10.0, "%");
+
+    // Stopping a real-time run must not wait out the current sleep
+    FarmingScheduler background;
+    background.queue().push_back(entry);
+    GameState backgroundGame;
+    background.start(backgroundGame, 1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    double stopMs = measureMs(1, [&](int) { background.finish(backgroundGame); });
+    ok &= report("stop a real-time background run", stopMs, 50.0, "ms");
+    return ok;
+}
+
+// Simulator time per exchange for one Epic dungeon. Combat is deterministic
+// apart from loot, which simulated runs skip, so one real run counts the
+// exchanges of every simulated one.
+static long long epicExchanges(const GameState& game, Biome biome) {
+    GameState counter = game;
+    return runDungeons(counter, biome, DungeonSize::EPIC, 1);
+}
+
+static double simulatedExchangeNs(const GameState& game, Biome biome, int trials) {
+    long long exchanges = epicExchanges(game, biome);
+    double ms = measureMs(1, [&](int) { game.projectRun(biome, DungeonSize::EPIC, trials); });
+    return ms * 1e6 / (static_cast<double>(exchanges) * trials);
+}
+
+// A player who survives every Epic dungeon, so every trial runs to the end
+static GameState tankPlayer(int attack) {
+    GameState game;
+    Player& player = game.getPlayer();
+    player.maxHealth = 1000000;
+    player.attack = attack;
+    player.defense = 50;
+    player.recalculateStats();
+    player.fullHeal();
+    return game;
+}
+
+// Lowers the attack of a tank wearing ring until an Epic run in biome takes
+// as many exchanges as a plain one, so the per-floor costs of spawning and
+// rewards weigh the same in both
+static GameState calibratedTank(const Item& ring, Biome biome, long long exchanges) {
+    GameState game;
+    for (int attack = 200; attack > 0; attack--) {
+        game = tankPlayer(attack);
+        game.editInventory().add(ring);
+        game.equipBest(GearRank::POWER);
+        if (epicExchanges(game, biome) >= exchanges) {
+            break;
+        }
+    }
+    return game;
+}
+
+static bool benchStatusEffects() {
+    printHeader("Status Effects");
+    bool ok = true;
+
+    // The plain player fights Forest enemies, which have no elements, so
+    // every exchange takes the path combat took before effects existed
+    GameState plain = tankPlayer(200);
+    long long plainExchanges = epicExchanges(plain, Biome::FOREST);
+
+    // One effect: a fire ring keeps Forest enemies burning
+    Item ring = {};
+    ring.slot = EquipSlot::RING;
+    ring.rarity = Rarity::LEGENDARY;
+    ring.itemLevel = 1;
+    ring.affixCount = 1;
+    ring.affixes[0] = packAffix(AffixStat::FIRE_DAMAGE, 20);
+    GameState burning = calibratedTank(ring, Biome::FOREST, plainExchanges);
+
+    // Five effects: a ring of every element keeps each enemy burning,
+    // frozen, poisoned and periodically stunned, while Volcano enemies keep
+    // the player burning
+    ring.affixCount = 4;
+    ring.affixes[1] = packAffix(AffixStat::FROST_DAMAGE, 20);
+    ring.affixes[2] = packAffix(AffixStat::POISON_DAMAGE, 20);
+    ring.affixes[3] = packAffix(AffixStat::LIGHTNING_DAMAGE, 20);
+    GameState elemental = calibratedTank(ring, Biome::VOLCANO, plainExchanges);
+    std::cout << "  " << plainExchanges << " plain, " << epicExchanges(burning, Biome::FOREST)
+              << " burning and " << epicExchanges(elemental, Biome::VOLCANO)
+              << " elemental exchanges per Epic run\n";
+
+    // Alternated, best of fifteen
+    const int trials = 200;
+    double plainNs = 1e9;
+    double burningNs = 1e9;
+    double effectsNs = 1e9;
+    for (int round = 0; round < 15; round++) {
+        plainNs = std::min(plainNs, simulatedExchangeNs(plain, Biome::FOREST, trials));
+        burningNs = std::min(burningNs, simulatedExchangeNs(burning, Biome::FOREST, trials));
+        effectsNs = std::min(effectsNs, simulatedExchangeNs(elemental, Biome::VOLCANO, trials));
+    }
+    std::cout << "  " << std::fixed << std::setprecision(1) << plainNs << " ns per plain exchange, "
+              << burningNs << " ns with one effect, " << effectsNs << " ns with five\n";
+    // Against the exchange without effects: one effect or five may add at
+    // most a fifth
+    ok &= report("exchange, one effect vs none", burningNs / plainNs, 1.2, "x");
+    ok &= report("exchange, five effects vs none", effectsNs / plainNs, 1.2, "x");
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok &= benchSaveSlots();
+    ok &= benchSnapshots();
+    ok &= benchCombatLog();
+    ok &= benchAchievements();
+    ok &= benchInventory();
+    ok &= benchBalance();
+    ok &= benchFarming();
+    ok &= benchStatusEffects();
+
+    std::cout << "\n" << (ok ? "All benchmarks met their targets." : "Some benchmarks missed their targets.")
+              << "\n";
+    return ok ? 0 : 1;
+}
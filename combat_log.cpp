@@ -0,0 +1,148 @@
+#include "combat_log.h"
+#include "game.h"
+#include "achievements.h"
+#include "loot.h"
+#include <fstream>
+#include <algorithm>
+
+// CombatLog implementation
+static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+CombatLog::CombatLog(std::size_t capacity)
+    : events(roundUpToPowerOfTwo(std::max<std::size_t>(1, capacity))),
+      mask(events.size() - 1), total(0), oldest(0) {}
+
+std::size_t CombatLog::size() const {
+    return static_cast<std::size_t>(std::min<std::uint64_t>(total - oldest, events.size()));
+}
+
+std::size_t CombatLog::capacity() const {
+    return events.size();
+}
+
+std::uint64_t CombatLog::totalRecorded() const {
+    return total;
+}
+
+const CombatEvent& CombatLog::at(std::size_t index) const {
+    return events[(total - size() + index) & mask];
+}
+
+std::size_t CombatLog::countSince(std::uint64_t mark) const {
+    if (mark >= total) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::min<std::uint64_t>(total - mark, size()));
+}
+
+void CombatLog::truncate(std::uint64_t mark) {
+    if (mark >= total) {
+        return;
+    }
+    // Slots before the retained window now hold newer events, so they can
+    // never come back into view
+    oldest = total - size();
+    total = std::max(mark, oldest);
+}
+
+void CombatLog::clear() {
+    total = 0;
+    oldest = 0;
+}
+
+// Formatting
+std::string formatCombatEvent(const CombatEvent& event, const GameState& game) {
+    switch (event.kind) {
+        case CombatEventKind::DUNGEON_STARTED:
+            return "🗺️  Entered " +
+                   game.getDungeonSizeInfo(static_cast<DungeonSize>(event.a)).displayName + " " +
+                   game.getBiomeName(static_cast<Biome>(event.detail)) + " dungeon";
+        case CombatEventKind::ENEMY_SPAWNED: {
+            Biome biome = static_cast<Biome>(event.a);
+            std::string name = event.detail == BOSS_ENEMY_TYPE
+                ? game.getBiomeName(biome) + " Boss"
+                : game.getEnemyTypeName(biome, event.detail);
+            return (event.detail == BOSS_ENEMY_TYPE ? "👑 " : "👾 ") + name +
+                   " appears on floor " + std::to_string(event.floor) +
+                   " (" + std::to_string(event.b) + " HP)";
+        }
+        case CombatEventKind::PLAYER_HIT:
+            return "💥 You dealt " + std::to_string(event.a) + " damage! (enemy HP " +
+                   std::to_string(event.b) + ")";
+        case CombatEventKind::ENEMY_HIT:
+            return "💔 Enemy dealt " + std::to_string(event.a) + " damage! (your HP " +
+                   std::to_string(event.b) + ")";
+        case CombatEventKind::ENEMY_DEFEATED:
+            return "🎉 Enemy defeated! +" + std::to_string(event.a) + " gold, +" +
+                   std::to_string(event.b) + " exp";
+        case CombatEventKind::LEVEL_UP:
+            return "⬆️  Level up! You are now level " + std::to_string(event.a);
+        case CombatEventKind::FLOOR_CLEARED:
+            return "✨ Floor " + std::to_string(event.floor) + " cleared! Healing 30%...";
+        case CombatEventKind::DUNGEON_COMPLETED:
+            return "🏆 DUNGEON COMPLETED! 🏆 (" +
+                   game.getDungeonSizeInfo(static_cast<DungeonSize>(event.a)).displayName + " " +
+                   game.getBiomeName(static_cast<Biome>(event.detail)) + ")";
+        case CombatEventKind::PLAYER_DIED:
+            return "💀 You have been defeated on floor " + std::to_string(event.floor) +
+                   "! Returning to town...";
+        case CombatEventKind::FLED:
+            return "🏃 Fled the dungeon from floor " + std::to_string(event.floor);
+        case CombatEventKind::ACHIEVEMENT_UNLOCKED:
+            if (event.a >= 0 &&
+                event.a < static_cast<int>(AchievementCatalog::instance().all().size())) {
+                return "🏅 Achievement unlocked: " + AchievementCatalog::instance().get(event.a).name;
+            }
+            break;
+        case CombatEventKind::ITEM_DROPPED:
+            return "🎁 Found a " + getRarityName(static_cast<Rarity>(event.detail)) + " " +
+                   getSlotName(static_cast<EquipSlot>(event.a)) + " (iLvl " +
+                   std::to_string(event.b) + ")";
+        case CombatEventKind::ITEM_SALVAGED:
+            return "♻️  Inventory full - salvaged a drop for " + std::to_string(event.a) + " gold";
+        case CombatEventKind::STATUS_APPLIED: {
+            static const char* const states[] = {"burning", "frozen", "poisoned", "stunned"};
+            if (event.detail >= STATUS_EFFECT_COUNT) {
+                break;
+            }
+            StatusEffect effect = static_cast<StatusEffect>(event.detail);
+            std::string text = getStatusEffectIcon(effect) + " " +
+                               (event.a == STATUS_TARGET_PLAYER ? "You are " : "Enemy is ") +
+                               states[event.detail] + "!";
+            // A stun always costs exactly one turn
+            return effect == StatusEffect::STUN ? text : text + " (" + std::to_string(event.b) + " turns)";
+        }
+        case CombatEventKind::STATUS_DAMAGE:
+            if (event.detail == STATUS_TARGET_PLAYER) {
+                return "🩸 Lingering effects dealt " + std::to_string(event.a) + " damage to you! (your HP " +
+                       std::to_string(event.b) + ")";
+            }
+            return "🩸 Lingering effects dealt " + std::to_string(event.a) + " damage to the enemy! (enemy HP " +
+                   std::to_string(event.b) + ")";
+        case CombatEventKind::TURN_SKIPPED:
+            return event.detail == STATUS_TARGET_PLAYER ? "💫 You are stunned and lose your turn!"
+                                                        : "💫 Enemy is stunned and loses its turn!";
+    }
+    return "Unknown event";
+}
+
+bool exportCombatLog(const CombatLog& log, const GameState& game, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::uint64_t firstSequence = log.totalRecorded() - log.size() + 1;
+    for (std::size_t i = 0; i < log.size(); i++) {
+        file << "#" << (firstSequence + i) << " " << formatCombatEvent(log.at(i), game) << "\n";
+    }
+
+    file.close();
+    return true;
+}
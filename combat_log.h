@@ -0,0 +1,85 @@
+#ifndef COMBAT_LOG_H
+#define COMBAT_LOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class GameState;
+
+enum class CombatEventKind : std::uint8_t {
+    DUNGEON_STARTED,    // detail: biome, a: dungeon size
+    ENEMY_SPAWNED,      // detail: enemy type index or BOSS_ENEMY_TYPE, a: biome, b: max health
+    PLAYER_HIT,         // a: damage dealt, b: enemy health left
+    ENEMY_HIT,          // a: damage taken, b: player health left
+    ENEMY_DEFEATED,     // a: gold reward, b: exp reward
+    LEVEL_UP,           // a: new level
+    FLOOR_CLEARED,
+    DUNGEON_COMPLETED,  // detail: biome, a: dungeon size
+    PLAYER_DIED,
+    FLED,
+    ACHIEVEMENT_UNLOCKED, // a: achievement id
+    ITEM_DROPPED,         // detail: rarity, a: slot, b: item level
+    ITEM_SALVAGED,        // a: gold gained (drop salvaged because the inventory was full)
+    STATUS_APPLIED,       // detail: StatusEffect, a: target, b: turns
+    STATUS_DAMAGE,        // detail: target, a: burn and poison damage, b: target health left
+    TURN_SKIPPED          // detail: target (stunned)
+};
+
+// One recorded event. Raw values only; text is produced on demand.
+struct CombatEvent {
+    CombatEventKind kind;
+    std::uint8_t detail;
+    std::uint16_t floor;
+    std::int32_t a;
+    std::int32_t b;
+};
+
+static_assert(sizeof(CombatEvent) == 12, "CombatEvent must stay compact");
+
+const std::uint8_t BOSS_ENEMY_TYPE = 0xFF;
+
+// Who a status event is about
+const std::uint8_t STATUS_TARGET_PLAYER = 0;
+const std::uint8_t STATUS_TARGET_ENEMY = 1;
+
+// Fixed-size ring buffer of combat events. Recording is a single struct
+// store with no allocation or formatting; once full, the oldest events are
+// overwritten. Capacity is rounded up to a power of two.
+class CombatLog {
+public:
+    static const std::size_t DEFAULT_CAPACITY = 8192;
+
+    explicit CombatLog(std::size_t capacity = DEFAULT_CAPACITY);
+
+    void record(CombatEventKind kind, std::uint8_t detail, int floor, int a = 0, int b = 0) {
+        events[total & mask] = {kind, detail, static_cast<std::uint16_t>(floor),
+                                static_cast<std::int32_t>(a), static_cast<std::int32_t>(b)};
+        total++;
+    }
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    std::uint64_t totalRecorded() const;
+    // Index 0 is the oldest retained event
+    const CombatEvent& at(std::size_t index) const;
+    // Events recorded since totalRecorded() returned mark, clamped to what is retained
+    std::size_t countSince(std::uint64_t mark) const;
+    // Drops the events recorded since totalRecorded() returned mark, as when
+    // the actions that produced them are rewound
+    void truncate(std::uint64_t mark);
+    void clear();
+
+private:
+    std::vector<CombatEvent> events;
+    std::size_t mask;
+    std::uint64_t total;
+    std::uint64_t oldest;   // Events before this were overwritten, even if total drops back
+};
+
+// Formatting (only used when the log is viewed or exported)
+std::string formatCombatEvent(const CombatEvent& event, const GameState& game);
+bool exportCombatLog(const CombatLog& log, const GameState& game, const std::string& filename);
+
+#endif // COMBAT_LOG_H
@@ -0,0 +1,45 @@
+#ifndef COW_PTR_H
+#define COW_PTR_H
+
+#include <memory>
+#include <cstddef>
+
+// Copy-on-write pointer. Copies share the pointee; the first write through a
+// shared pointer clones it, so a copy never observes the other's mutations.
+// Not thread-safe across copies that are mutated concurrently; detach() a
+// copy before handing it to another thread.
+template <typename T>
+class CowPtr {
+public:
+    CowPtr() = default;
+    CowPtr(std::nullptr_t) {}
+    explicit CowPtr(std::shared_ptr<T> p) : ptr(std::move(p)) {}
+
+    const T* get() const { return ptr.get(); }
+    const T& operator*() const { return *ptr; }
+    const T* operator->() const { return ptr.get(); }
+    explicit operator bool() const { return static_cast<bool>(ptr); }
+
+    // Mutable access; clones the pointee first if another copy shares it
+    T& write() {
+        if (ptr.use_count() > 1) {
+            ptr = std::make_shared<T>(*ptr);
+        }
+        return *ptr;
+    }
+
+    // Clones the pointee unconditionally, so no other copy can share it
+    void detach() {
+        if (ptr) {
+            ptr = std::make_shared<T>(*ptr);
+        }
+    }
+
+    std::shared_ptr<const T> shared() const { return ptr; }
+    bool isShared() const { return ptr.use_count() > 1; }
+
+private:
+    std::shared_ptr<T> ptr;
+};
+
+#endif // COW_PTR_H
@@ -0,0 +1,229 @@
+#include "farming.h"
+#include <chrono>
+
+// Purchases per upgrade rule application, in case a formula makes upgrades free
+static const int MAX_UPGRADES_PER_RUN = 1000;
+
+// FarmingReport implementation
+double FarmingReport::runsPerSimHour() const {
+    return simSeconds > 0 ? runs * 3600.0 / simSeconds : 0.0;
+}
+
+double FarmingReport::runsPerWallHour() const {
+    return wallSeconds > 0 ? runs * 3600.0 / wallSeconds : 0.0;
+}
+
+// FarmingScheduler implementation
+FarmingScheduler::FarmingScheduler()
+    : rng(std::random_device{}()), stopRequested(false), status() {}
+
+FarmingScheduler::~FarmingScheduler() {
+    stop();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::vector<FarmEntry>& FarmingScheduler::queue() {
+    return entries;
+}
+
+const std::vector<FarmEntry>& FarmingScheduler::queue() const {
+    return entries;
+}
+
+bool FarmingScheduler::entryDone(const FarmEntry& entry, const GameState& game, int entryRuns) const {
+    switch (entry.goal) {
+        case FarmGoal::RUNS:
+            return entryRuns >= entry.target;
+        case FarmGoal::LEVEL:
+            return game.getPlayer().level >= entry.target || entryRuns >= MAX_CONDITION_RUNS;
+        case FarmGoal::GOLD:
+            return game.getPlayer().gold >= entry.target || entryRuns >= MAX_CONDITION_RUNS;
+    }
+    return true;
+}
+
+int FarmingScheduler::applyUpgradeRule(UpgradeRule rule, GameState& game) const {
+    static const char* const stats[] = {"health", "attack", "defense"};
+    int bought = 0;
+
+    while (rule != UpgradeRule::NONE && bought < MAX_UPGRADES_PER_RUN) {
+        std::string stat;
+        if (rule == UpgradeRule::CHEAPEST) {
+            stat = stats[0];
+            for (const char* candidate : stats) {
+                if (game.getUpgradeCost(candidate) < game.getUpgradeCost(stat)) {
+                    stat = candidate;
+                }
+            }
+        } else {
+            stat = stats[static_cast<int>(rule) - static_cast<int>(UpgradeRule::HEALTH)];
+        }
+
+        if (!game.upgradeStat(stat)) {
+            break;
+        }
+        bought++;
+    }
+    return bought;
+}
+
+void FarmingScheduler::publish(const FarmingReport& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    status = snapshot;
+}
+
+bool FarmingScheduler::waitUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !wake.wait_until(lock, deadline, [this] { return stopRequested.load(); });
+}
+
+FarmingReport FarmingScheduler::run(GameState& game, double speed) {
+    using Clock = std::chrono::steady_clock;
+
+    FarmingReport report = {};
+    report.running = true;
+    int startLevel = game.getPlayer().level;
+    Clock::time_point wallStart = Clock::now();
+    double nextPace = PACE_SLICE_SECONDS;
+
+    // Once per slice of simulated time: publish progress and, when paced,
+    // sleep until wall time catches up with the simulation clock
+    auto pace = [&]() {
+        report.wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+        report.levelsGained = game.getPlayer().level - startLevel;
+        publish(report);
+        nextPace = report.simSeconds + PACE_SLICE_SECONDS;
+        if (speed > 0) {
+            auto due = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(report.simSeconds / speed));
+            return waitUntil(wallStart + due);
+        }
+        return !stopRequested;
+    };
+
+    for (std::size_t i = 0; i < entries.size() && !stopRequested; i++) {
+        const FarmEntry entry = entries[i];
+        report.entryIndex = i;
+        report.entryRuns = 0;
+
+        while (!stopRequested && !entryDone(entry, game, report.entryRuns)) {
+            report.upgradesBought += applyUpgradeRule(entry.upgrade, game);
+            if (entry.equipBest) {
+                game.equipBest(GearRank::POWER);
+            }
+
+            int goldBefore = game.getPlayer().gold;
+            bool aborted = false;
+            game.startDungeon(entry.biome, entry.size);
+            report.simSeconds += FARM_TOWN_SECONDS;
+            while (game.isInDungeon()) {
+                CombatResult result = game.attackEnemy();
+                report.exchanges++;
+                report.simSeconds += FARM_EXCHANGE_SECONDS;
+                report.clears += result.dungeonCompleted;
+                report.deaths += result.playerDied;
+                if (report.simSeconds >= nextPace && !pace()) {
+                    game.fleeDungeon();
+                    aborted = true;
+                }
+            }
+            report.goldEarned += game.getPlayer().gold - goldBefore;
+
+            if (!aborted) {
+                report.runs++;
+                report.entryRuns++;
+            }
+        }
+    }
+
+    if (!stopRequested) {
+        report.entryIndex = entries.size();
+    }
+    report.running = false;
+    report.wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    report.levelsGained = game.getPlayer().level - startLevel;
+    publish(report);
+    return report;
+}
+
+bool FarmingScheduler::start(const GameState& game, double speed) {
+    if (worker.joinable() || entries.empty()) {
+        return false;
+    }
+
+    farmed = game;
+    farmed.detach();
+    log.clear();
+    farmed.setCombatLog(&log);
+    farmed.setRandomEngine(&rng);
+    stopRequested = false;
+    FarmingReport initial = {};
+    initial.running = true;
+    publish(initial);
+    worker = std::thread([this, speed] { run(farmed, speed); });
+    return true;
+}
+
+void FarmingScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wake.notify_all();
+}
+
+bool FarmingScheduler::isRunning() const {
+    return report().running;
+}
+
+FarmingReport FarmingScheduler::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return status;
+}
+
+FarmingReport FarmingScheduler::finish(GameState& game) {
+    if (worker.joinable()) {
+        stop();
+        worker.join();
+
+        CombatLog* callerLog = game.getCombatLog();
+        if (callerLog) {
+            for (std::size_t i = 0; i < log.size(); i++) {
+                const CombatEvent& event = log.at(i);
+                callerLog->record(event.kind, event.detail, event.floor, event.a, event.b);
+            }
+        }
+        game = farmed;
+        game.setCombatLog(callerLog);
+        game.setRandomEngine(nullptr);
+    }
+    stopRequested = false;
+    return report();
+}
+
+std::string FarmingScheduler::describeEntry(const GameState& game, const FarmEntry& entry) {
+    std::string text = game.getDungeonSizeInfo(entry.size).displayName + " " +
+                       game.getBiomeName(entry.biome);
+    switch (entry.goal) {
+        case FarmGoal::RUNS:
+            text += " x" + std::to_string(entry.target) + (entry.target == 1 ? " run" : " runs");
+            break;
+        case FarmGoal::LEVEL:
+            text += " until level " + std::to_string(entry.target);
+            break;
+        case FarmGoal::GOLD:
+            text += " until " + std::to_string(entry.target) + " gold";
+            break;
+    }
+
+    static const char* const ruleNames[] = {"", "health", "attack", "defense", "cheapest"};
+    if (entry.upgrade != UpgradeRule::NONE) {
+        text += std::string(", upgrade ") + ruleNames[static_cast<int>(entry.upgrade)];
+    }
+    if (entry.equipBest) {
+        text += ", equip best";
+    }
+    return text;
+}
@@ -0,0 +1,119 @@
+#ifndef FARMING_H
+#define FARMING_H
+
+#include "game.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <random>
+
+// When a queue entry is done
+enum class FarmGoal : std::uint8_t {
+    RUNS,       // After target runs
+    LEVEL,      // Once the player reaches level target
+    GOLD        // Once the player holds target gold
+};
+
+// Upgrades bought with all affordable gold before each run
+enum class UpgradeRule : std::uint8_t {
+    NONE,
+    HEALTH,
+    ATTACK,
+    DEFENSE,
+    CHEAPEST    // Whichever upgrade costs least, repeatedly
+};
+
+struct FarmEntry {
+    Biome biome;
+    DungeonSize size;
+    FarmGoal goal;
+    int target;
+    UpgradeRule upgrade;
+    bool equipBest;     // Equip the best gear by overall power before each run
+};
+
+// Simulated seconds per combat exchange (the interactive auto-battle pace)
+// and per trip back to town between runs
+const double FARM_EXCHANGE_SECONDS = 0.5;
+const double FARM_TOWN_SECONDS = 5.0;
+
+struct FarmingReport {
+    int runs;
+    int clears;
+    int deaths;
+    long long exchanges;
+    std::size_t entryIndex;     // Entry being farmed (queue size once finished)
+    int entryRuns;              // Runs spent on the current entry
+    double simSeconds;
+    double wallSeconds;
+    long long goldEarned;
+    int levelsGained;
+    int upgradesBought;
+    bool running;
+
+    double runsPerSimHour() const;
+    double runsPerWallHour() const;
+};
+
+// Farms an ordered queue of dungeons back to back on a simulation clock.
+//
+// Each exchange and each trip to town advances the clock by a fixed amount
+// of simulated time. With a speed of N the scheduler keeps wall time at
+// simulated time / N, sleeping once per slice of simulated time rather than
+// once per exchange; a speed of 0 runs as fast as the CPU allows.
+//
+// start() farms on a worker thread against a copy of the game, so the
+// caller's state is untouched until finish() hands the farmed state back.
+// The copy is detached from the caller's copy-on-write storage, records
+// into the scheduler's own combat log and rolls with its own engine;
+// finish() replays that log into the caller's.
+class FarmingScheduler {
+public:
+    // Simulated time between pacing checks
+    static const int PACE_SLICE_SECONDS = 10;
+    // Run cap for LEVEL and GOLD entries that never reach their target
+    static const int MAX_CONDITION_RUNS = 10000;
+
+    FarmingScheduler();
+    ~FarmingScheduler();
+
+    // Queue editing (not while running)
+    std::vector<FarmEntry>& queue();
+    const std::vector<FarmEntry>& queue() const;
+
+    // Farms the queue on the calling thread
+    FarmingReport run(GameState& game, double speed);
+
+    // Background farming
+    bool start(const GameState& game, double speed);
+    void stop();
+    bool isRunning() const;
+    FarmingReport report() const;
+    // Stops the worker if needed, then replaces game with the farmed state
+    FarmingReport finish(GameState& game);
+
+    static std::string describeEntry(const GameState& game, const FarmEntry& entry);
+
+private:
+    std::vector<FarmEntry> entries;
+
+    std::thread worker;
+    GameState farmed;
+    CombatLog log;
+    std::mt19937 rng;
+    std::atomic<bool> stopRequested;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    FarmingReport status;
+
+    bool entryDone(const FarmEntry& entry, const GameState& game, int entryRuns) const;
+    int applyUpgradeRule(UpgradeRule rule, GameState& game) const;
+    void publish(const FarmingReport& snapshot);
+    bool waitUntil(std::chrono::steady_clock::time_point deadline);
+};
+
+#endif // FARMING_H
@@ -1,20 +1,35 @@
 #include "game.h"
+#include "save_slots.h"
+#include "farming.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
 #include <cmath>
 #include <random>
 #include <algorithm>
 #include <thread>
 #include <chrono>
 
-// Random number generator
+// Random number generator shared by every GameState without its own engine
 static std::random_device rd;
 static std::mt19937 gen(rd());
 
+// Combat actions that can be rewound, and simulated runs per upgrade preview
+static const size_t REWIND_DEPTH = 20;
+static const int PREVIEW_TRIALS = 20;
+
+// Percent chance for a regular enemy to drop an item; bosses always drop
+static const int LOOT_DROP_CHANCE = 20;
+
+// Item ids per line of the saved "items" array
+static const std::uint32_t SAVE_ITEMS_PER_LINE = 64;
+
 // Enemy implementation
 Enemy::Enemy(const std::string& n, int h, int atk, int def, int gold, int exp)
     : name(n), health(h), maxHealth(h), attack(atk), defense(def), 
-      goldReward(gold), expReward(exp) {}
+      goldReward(gold), expReward(exp), element(Element::PHYSICAL), inflicts(0), resistPercent() {}
 
 bool Enemy::isAlive() const {
     return health > 0;
@@ -26,28 +41,45 @@ int Enemy::takeDamage(int damage) {
     return actualDamage;
 }
 
+int Enemy::loseHealth(int amount) {
+    amount = std::max(0, amount);
+    health = std::max(0, health - amount);
+    return amount;
+}
+
 // Player implementation
 Player::Player()
     : name("Hero"), level(1), health(100), maxHealth(100), attack(10), 
       defense(5), gold(0), experience(0), expToNextLevel(100), 
-      floorsCleared(0), dungeonsCompleted(0) {}
+      floorsCleared(0), dungeonsCompleted(0), gear() {
+    recalculateStats();
+}
 
 bool Player::isAlive() const {
     return health > 0;
 }
 
-int Player::takeDamage(int damage) {
-    int actualDamage = std::max(1, damage - defense);
+int Player::takeDamage(int damage, Element element) {
+    int actualDamage = std::max(1, damage - effectiveDefense);
+    if (element != Element::PHYSICAL) {
+        actualDamage = std::max(1, actualDamage * (100 - resistPercent[static_cast<size_t>(element)]) / 100);
+    }
     health = std::max(0, health - actualDamage);
     return actualDamage;
 }
 
+int Player::loseHealth(int amount) {
+    amount = std::max(0, amount);
+    health = std::max(0, health - amount);
+    return amount;
+}
+
 void Player::heal(int amount) {
-    health = std::min(maxHealth, health + amount);
+    health = std::min(effectiveMaxHealth, health + amount);
 }
 
 void Player::fullHeal() {
-    health = maxHealth;
+    health = effectiveMaxHealth;
 }
 
 void Player::gainExperience(int exp) {
@@ -58,13 +90,17 @@ void Player::gainExperience(int exp) {
 }
 
 void Player::levelUp() {
+    const BalanceSheet& balance = BalanceSheet::instance();
     experience -= expToNextLevel;
     level++;
-    maxHealth += 20;
-    health = maxHealth;
-    attack += 5;
-    defense += 2;
-    expToNextLevel = static_cast<int>(expToNextLevel * 1.5);
+    BalanceInputs inputs = balanceInputs();
+    maxHealth += balance.evaluateInt(BalanceFormula::LEVEL_HEALTH, inputs);
+    attack += balance.evaluateInt(BalanceFormula::LEVEL_ATTACK, inputs);
+    defense += balance.evaluateInt(BalanceFormula::LEVEL_DEFENSE, inputs);
+    recalculateStats();
+    health = effectiveMaxHealth;
+    // Never below 1, or gainExperience would level up forever
+    expToNextLevel = std::max(1, balance.evaluateInt(BalanceFormula::NEXT_LEVEL_EXP, inputs));
 }
 
 bool Player::canAfford(int cost) const {
@@ -79,32 +115,90 @@ bool Player::spendGold(int amount) {
     return false;
 }
 
+void Player::applyEquipment(const EquipmentBonus& bonus) {
+    gear = bonus;
+    recalculateStats();
+}
+
+void Player::recalculateStats() {
+    effectiveAttack = attack + gear.attack;
+    effectiveDefense = defense + gear.defense;
+    effectiveMaxHealth = maxHealth + gear.maxHealth;
+    health = std::min(health, effectiveMaxHealth);
+    for (size_t e = 0; e < ELEMENT_COUNT; e++) {
+        resistPercent[e] = std::min(MAX_RESIST_PERCENT, gear.resistPercent[e]);
+    }
+}
+
+BalanceInputs Player::balanceInputs() const {
+    BalanceInputs inputs;
+    inputs[BalanceVar::LEVEL] = level;
+    inputs[BalanceVar::EXP_TO_NEXT] = expToNextLevel;
+    inputs[BalanceVar::MAX_HEALTH] = maxHealth;
+    inputs[BalanceVar::ATTACK] = attack;
+    inputs[BalanceVar::DEFENSE] = defense;
+    return inputs;
+}
+
 // GameState implementation
 GameState::GameState()
-    : currentFloor(0), autoBattle(false), inDungeon(false), gameRunning(true) {
-    initializeData();
+    : currentBiome(Biome::FOREST), currentDungeonSize(DungeonSize::SMALL), currentFloor(0),
+      autoBattle(false), inDungeon(false), damageTakenThisRun(0),
+      inventory(std::make_shared<Inventory>()), simulated(false), elementalHit(0),
+      elementalPotency(),
+      data(initializeData()), combatLog(nullptr), rng(&gen),
+      gameRunning(true) {
+    achievements.raiseTo(AchievementCounter::LEVEL, player.level, [](std::uint16_t) {});
 }
 
-void GameState::initializeData() {
-    // Initialize biome names
-    biomeNames[Biome::FOREST] = "Forest";
-    biomeNames[Biome::CAVE] = "Cave";
-    biomeNames[Biome::DESERT] = "Desert";
-    biomeNames[Biome::ICE] = "Ice Cavern";
-    biomeNames[Biome::VOLCANO] = "Volcano";
-    
-    // Initialize enemy types
-    enemyTypes[Biome::FOREST] = {"Goblin", "Wolf", "Bear", "Troll"};
-    enemyTypes[Biome::CAVE] = {"Bat", "Spider", "Slime", "Golem"};
-    enemyTypes[Biome::DESERT] = {"Scorpion", "Snake", "Mummy", "Sand Elemental"};
-    enemyTypes[Biome::ICE] = {"Ice Sprite", "Frost Wolf", "Yeti", "Ice Dragon"};
-    enemyTypes[Biome::VOLCANO] = {"Fire Imp", "Lava Golem", "Magma Worm", "Phoenix"};
-    
-    // Initialize dungeon size info
-    dungeonSizeInfo[DungeonSize::SMALL] = {"Small", 5, 1.0};
-    dungeonSizeInfo[DungeonSize::MEDIUM] = {"Medium", 10, 1.5};
-    dungeonSizeInfo[DungeonSize::LARGE] = {"Large", 20, 2.0};
-    dungeonSizeInfo[DungeonSize::EPIC] = {"Epic", 50, 3.0};
+std::shared_ptr<const GameData> GameState::initializeData() {
+    // Built once and shared by every GameState, including snapshots
+    static const std::shared_ptr<const GameData> shared = [] {
+        auto tables = std::make_shared<GameData>();
+        
+        // Initialize biome names
+        tables->biomeNames[Biome::FOREST] = "Forest";
+        tables->biomeNames[Biome::CAVE] = "Cave";
+        tables->biomeNames[Biome::DESERT] = "Desert";
+        tables->biomeNames[Biome::ICE] = "Ice Cavern";
+        tables->biomeNames[Biome::VOLCANO] = "Volcano";
+        
+        // Initialize enemy types
+        tables->enemyTypes[Biome::FOREST] = {"Goblin", "Wolf", "Bear", "Troll"};
+        tables->enemyTypes[Biome::CAVE] = {"Bat", "Spider", "Slime", "Golem"};
+        tables->enemyTypes[Biome::DESERT] = {"Scorpion", "Snake", "Mummy", "Sand Elemental"};
+        tables->enemyTypes[Biome::ICE] = {"Ice Sprite", "Frost Wolf", "Yeti", "Ice Dragon"};
+        tables->enemyTypes[Biome::VOLCANO] = {"Fire Imp", "Lava Golem", "Magma Worm", "Phoenix"};
+        
+        // Initialize biome affinities (resistances in Element order:
+        // physical, fire, frost, poison, lightning)
+        tables->affinities[Biome::FOREST] = {Element::PHYSICAL, 0, {{0, 0, 0, 0, 0}}};
+        tables->affinities[Biome::CAVE] = {Element::PHYSICAL, statusBit(StatusEffect::STUN),
+                                           {{0, -25, 0, 25, 0}}};
+        tables->affinities[Biome::DESERT] = {Element::POISON, statusBit(StatusEffect::POISON),
+                                             {{0, 25, -50, 50, 0}}};
+        tables->affinities[Biome::ICE] = {Element::FROST, statusBit(StatusEffect::FREEZE),
+                                          {{0, -50, 50, 0, 0}}};
+        tables->affinities[Biome::VOLCANO] = {Element::FIRE, statusBit(StatusEffect::BURN),
+                                              {{0, 50, -50, 0, 0}}};
+        
+        // Initialize dungeon size info
+        tables->dungeonSizeInfo[DungeonSize::SMALL] = {"Small", 5, 1.0};
+        tables->dungeonSizeInfo[DungeonSize::MEDIUM] = {"Medium", 10, 1.5};
+        tables->dungeonSizeInfo[DungeonSize::LARGE] = {"Large", 20, 2.0};
+        tables->dungeonSizeInfo[DungeonSize::EPIC] = {"Epic", 50, 3.0};
+        
+        // Evaluate the enemy curves for every floor of every size up front
+        const BalanceSheet& balance = BalanceSheet::instance();
+        for (const auto& entry : tables->dungeonSizeInfo) {
+            const DungeonSizeInfo& info = entry.second;
+            FloorScaling& scaling = tables->enemyScaling[entry.first];
+            scaling.floors = balance.evaluateFloorScaling(info.floors, info.difficultyMultiplier);
+            scaling.boss = balance.evaluateEnemyScaling(info.floors, info.difficultyMultiplier, true);
+        }
+        return std::shared_ptr<const GameData>(tables);
+    }();
+    return shared;
 }
 
 Player& GameState::getPlayer() {
@@ -127,8 +221,8 @@ int GameState::getCurrentFloor() const {
     return currentFloor;
 }
 
-std::shared_ptr<Enemy> GameState::getCurrentEnemy() const {
-    return currentEnemy;
+std::shared_ptr<const Enemy> GameState::getCurrentEnemy() const {
+    return currentEnemy.shared();
 }
 
 bool GameState::isAutoBattle() const {
@@ -139,45 +233,96 @@ bool GameState::isInDungeon() const {
     return inDungeon;
 }
 
+const AchievementTracker& GameState::getAchievements() const {
+    return achievements;
+}
+
+const Inventory& GameState::getInventory() const {
+    return *inventory;
+}
+
+void GameState::setCombatLog(CombatLog* log) {
+    combatLog = log;
+}
+
+CombatLog* GameState::getCombatLog() const {
+    return combatLog;
+}
+
+void GameState::setRandomEngine(std::mt19937* engine) {
+    rng = engine ? engine : &gen;
+}
+
+void GameState::detach() {
+    currentEnemy.detach();
+    inventory.detach();
+    inventory.write().detach();
+}
+
+void GameState::addToCounter(AchievementCounter counter, std::int64_t delta) {
+    achievements.add(counter, delta, [this](std::uint16_t id) {
+        logEvent(CombatEventKind::ACHIEVEMENT_UNLOCKED, 0, id);
+    });
+}
+
+void GameState::raiseCounter(AchievementCounter counter, std::int64_t value) {
+    achievements.raiseTo(counter, value, [this](std::uint16_t id) {
+        logEvent(CombatEventKind::ACHIEVEMENT_UNLOCKED, 0, id);
+    });
+}
+
 void GameState::startDungeon(Biome biome, DungeonSize size) {
     currentBiome = biome;
     currentDungeonSize = size;
     currentFloor = 1;
     inDungeon = true;
+    damageTakenThisRun = 0;
     player.fullHeal();
+    player.status.clear();
+    logEvent(CombatEventKind::DUNGEON_STARTED, static_cast<std::uint8_t>(biome),
+             static_cast<int>(size));
     spawnEnemy();
 }
 
 void GameState::spawnEnemy() {
     if (!inDungeon) return;
     
-    // Base enemy stats scale with floor
-    double floorMultiplier = 1.0 + (currentFloor - 1) * 0.2;
-    double difficulty = dungeonSizeInfo[currentDungeonSize].difficultyMultiplier;
-    
-    int baseHealth = static_cast<int>(50 * floorMultiplier * difficulty);
-    int baseAttack = static_cast<int>(8 * floorMultiplier * difficulty);
-    int baseDefense = static_cast<int>(3 * floorMultiplier * difficulty);
-    int baseGold = static_cast<int>(10 * floorMultiplier * difficulty);
-    int baseExp = static_cast<int>(20 * floorMultiplier * difficulty);
+    // Enemy stats come from the precomputed balance tables
+    const DungeonSizeInfo& sizeInfo = data->dungeonSizeInfo.at(currentDungeonSize);
+    const FloorScaling& scaling = data->enemyScaling.at(currentDungeonSize);
+    bool boss = currentFloor == sizeInfo.floors;
+    EnemyScaling stats;
+    if (boss) {
+        stats = scaling.boss;
+    } else if (currentFloor >= 1 && currentFloor <= static_cast<int>(scaling.floors.size())) {
+        stats = scaling.floors[currentFloor - 1];
+    } else {
+        stats = BalanceSheet::instance().evaluateEnemyScaling(
+            currentFloor, sizeInfo.difficultyMultiplier, false);
+    }
     
     // Select random enemy type
-    const auto& types = enemyTypes[currentBiome];
+    const auto& types = data->enemyTypes.at(currentBiome);
     std::uniform_int_distribution<> dis(0, types.size() - 1);
-    std::string enemyName = types[dis(gen)];
+    int typeIndex = dis(*rng);
+    std::string enemyName = types[typeIndex];
+    std::uint8_t enemyType = static_cast<std::uint8_t>(typeIndex);
     
     // Boss on final floor
-    if (currentFloor == dungeonSizeInfo[currentDungeonSize].floors) {
-        enemyName = biomeNames[currentBiome] + " Boss";
-        baseHealth = static_cast<int>(baseHealth * 2.5);
-        baseAttack = static_cast<int>(baseAttack * 1.5);
-        baseDefense = static_cast<int>(baseDefense * 1.5);
-        baseGold = static_cast<int>(baseGold * 3);
-        baseExp = static_cast<int>(baseExp * 3);
+    if (boss) {
+        enemyName = data->biomeNames.at(currentBiome) + " Boss";
+        enemyType = BOSS_ENEMY_TYPE;
     }
     
-    currentEnemy = std::make_shared<Enemy>(enemyName, baseHealth, baseAttack, 
-                                          baseDefense, baseGold, baseExp);
+    auto enemy = std::make_shared<Enemy>(enemyName, stats.health, stats.attack, stats.defense,
+                                         stats.gold, stats.exp);
+    const BiomeAffinity& affinity = data->affinities.at(currentBiome);
+    enemy->element = affinity.element;
+    enemy->inflicts = affinity.inflicts;
+    enemy->resistPercent = affinity.resistPercent;
+    currentEnemy = CowPtr<Enemy>(std::move(enemy));
+    resolveElementalHit();
+    logEvent(CombatEventKind::ENEMY_SPAWNED, enemyType, static_cast<int>(currentBiome), stats.health);
 }
 
 CombatResult GameState::attackEnemy() {
@@ -186,52 +331,211 @@ CombatResult GameState::attackEnemy() {
     if (!currentEnemy || !currentEnemy->isAlive()) {
         return result;
     }
+    // Defeats below replace the enemy, after which it is never touched again
+    Enemy& enemy = currentEnemy.write();
+    
+    // Effects and elements take their own exchange, so a fight without any
+    // costs what it did before they existed
+    if ((player.status.active | enemy.status.active | player.gear.elementMask | enemy.inflicts) != 0 ||
+        enemy.element != Element::PHYSICAL) {
+        exchangeWithEffects(enemy, result);
+        return result;
+    }
     
     // Player attacks
-    result.playerDamage = currentEnemy->takeDamage(player.attack);
-    
-    // Check if enemy is defeated
-    if (!currentEnemy->isAlive()) {
-        result.enemyDefeated = true;
-        player.gold += currentEnemy->goldReward;
-        player.gainExperience(currentEnemy->expReward);
-        player.floorsCleared++;
-        
-        // Check if dungeon is completed
-        if (currentFloor >= dungeonSizeInfo[currentDungeonSize].floors) {
-            result.dungeonCompleted = true;
-            player.dungeonsCompleted++;
-            currentFloor = 0;
-            currentEnemy = nullptr;
-            inDungeon = false;
-            autoBattle = false;
-            return result;
-        } else {
-            // Advance to next floor
-            currentFloor++;
-            result.floorCleared = true;
-            player.heal(static_cast<int>(player.maxHealth * 0.3));
-            spawnEnemy();
-            return result;
-        }
+    result.playerDamage = enemy.takeDamage(player.effectiveAttack);
+    logEvent(CombatEventKind::PLAYER_HIT, 0, result.playerDamage, enemy.health);
+    addToCounter(AchievementCounter::DAMAGE_DEALT, result.playerDamage);
+    if (!enemy.isAlive()) {
+        defeatEnemy(result);
+        return result;
     }
     
     // Enemy attacks back
-    if (currentEnemy->isAlive()) {
-        result.enemyDamage = player.takeDamage(currentEnemy->attack);
+    result.enemyDamage = player.takeDamage(enemy.attack, Element::PHYSICAL);
+    logEvent(CombatEventKind::ENEMY_HIT, 0, result.enemyDamage, player.health);
+    damageTakenThisRun += result.enemyDamage;
+    if (!player.isAlive()) {
+        defeatPlayer(result);
+    }
+    
+    return result;
+}
+
+// One exchange with status effects or elements in play; each effect step
+// only runs when its mask is non-zero
+void GameState::exchangeWithEffects(Enemy& enemy, CombatResult& result) {
+    // Player's turn
+    StatusTurn turn = {0, 100, false};
+    if (player.status.any()) {
+        turn = player.status.beginTurn();
+        if (turn.damage > 0) {
+            int taken = player.loseHealth(turn.damage);
+            logEvent(CombatEventKind::STATUS_DAMAGE, STATUS_TARGET_PLAYER, taken, player.health);
+            result.enemyDamage += taken;
+            damageTakenThisRun += taken;
+            if (!player.isAlive()) {
+                defeatPlayer(result);
+                return;
+            }
+        }
+    }
+    
+    if (turn.stunned) {
+        logEvent(CombatEventKind::TURN_SKIPPED, STATUS_TARGET_PLAYER);
+    } else {
+        result.playerDamage = enemy.takeDamage(turn.scale(player.effectiveAttack));
         
-        if (!player.isAlive()) {
-            result.playerDied = true;
-            // Reset to town
-            currentFloor = 0;
-            currentEnemy = nullptr;
-            inDungeon = false;
-            autoBattle = false;
-            player.fullHeal();
+        // Elemental gear adds damage past defense, then inflicts its effects
+        if (elementalHit > 0) {
+            result.playerDamage += enemy.loseHealth(turn.scale(elementalHit));
+        }
+        logEvent(CombatEventKind::PLAYER_HIT, 0, result.playerDamage, enemy.health);
+        if (player.gear.elementMask != 0 && enemy.isAlive()) {
+            // Potencies against this enemy are resolved on spawn, so
+            // starting effects costs no more than keeping them up
+            std::uint8_t fresh = enemy.status.refresh(elementEffects(player.gear.elementMask));
+            if (fresh != 0) {
+                enemy.status.start(fresh, elementalPotency);
+                if (combatLog) {
+                    logEffectsStarted(STATUS_TARGET_ENEMY, enemy.status, fresh);
+                }
+            }
         }
     }
     
-    return result;
+    // Enemy's turn: its effects age even if the hit defeated it, but deal
+    // damage only while it is alive. A defeat by either is handled once, below.
+    turn = {0, 100, false};
+    if (enemy.status.any()) {
+        turn = enemy.status.beginTurn();
+        const int dealt = enemy.loseHealth(enemy.isAlive() ? turn.damage : 0);
+        if (dealt > 0) {
+            logEvent(CombatEventKind::STATUS_DAMAGE, STATUS_TARGET_ENEMY, dealt, enemy.health);
+        }
+        result.playerDamage += dealt;
+    }
+    
+    // The hit and any damage over time count towards achievements together
+    addToCounter(AchievementCounter::DAMAGE_DEALT, result.playerDamage);
+    if (!enemy.isAlive()) {
+        defeatEnemy(result);
+        return;
+    }
+    
+    if (turn.stunned) {
+        logEvent(CombatEventKind::TURN_SKIPPED, STATUS_TARGET_ENEMY);
+        return;
+    }
+    
+    // Enemy attacks back
+    int hit = player.takeDamage(turn.scale(enemy.attack), enemy.element);
+    result.enemyDamage += hit;
+    logEvent(CombatEventKind::ENEMY_HIT, 0, hit, player.health);
+    damageTakenThisRun += hit;
+    
+    if (!player.isAlive()) {
+        defeatPlayer(result);
+        return;
+    }
+    // Enemy effects scale with each hit, so the player's are started one by one
+    const std::uint8_t fresh = enemy.inflicts != 0 ? player.status.refresh(enemy.inflicts) : 0;
+    for (std::uint32_t mask = fresh; mask != 0; mask &= mask - 1) {
+        player.status.apply(static_cast<StatusEffect>(lowestSetBit(mask)), hit, player.resistPercent);
+    }
+    if (combatLog && fresh != 0) {
+        logEffectsStarted(STATUS_TARGET_PLAYER, player.status, fresh);
+    }
+}
+
+void GameState::logEffectsStarted(std::uint8_t target, const StatusEffects& status, std::uint8_t effects) {
+    for (std::uint32_t mask = effects; mask != 0; mask &= mask - 1) {
+        StatusEffect effect = static_cast<StatusEffect>(lowestSetBit(mask));
+        logEvent(CombatEventKind::STATUS_APPLIED, static_cast<std::uint8_t>(effect), target,
+                 status.turnsLeft(effect));
+    }
+}
+
+void GameState::resolveElementalHit() {
+    elementalHit = 0;
+    elementalPotency.fill(0);
+    if (!currentEnemy) {
+        return;
+    }
+    for (std::uint32_t mask = player.gear.elementMask; mask != 0; mask &= mask - 1) {
+        size_t element = lowestSetBit(mask);
+        int damage = player.gear.elementDamage[element] * (100 - currentEnemy->resistPercent[element]) / 100;
+        elementalHit += std::max(0, damage);
+        if (element != static_cast<size_t>(Element::PHYSICAL)) {
+            StatusEffect effect = static_cast<StatusEffect>(element - 1);
+            elementalPotency[static_cast<size_t>(effect)] = StatusEffects::potencyOf(
+                effect, player.gear.elementDamage[element], currentEnemy->resistPercent);
+        }
+    }
+}
+
+void GameState::defeatEnemy(CombatResult& result) {
+    result.enemyDefeated = true;
+    int previousLevel = player.level;
+    int goldGained = currentEnemy->goldReward * (100 + player.gear.goldFindPercent) / 100;
+    int expGained = currentEnemy->expReward * (100 + player.gear.expBonusPercent) / 100;
+    player.gold += goldGained;
+    player.gainExperience(expGained);
+    player.floorsCleared++;
+    logEvent(CombatEventKind::ENEMY_DEFEATED, 0, goldGained, expGained);
+    if (player.level > previousLevel) {
+        logEvent(CombatEventKind::LEVEL_UP, 0, player.level);
+        raiseCounter(AchievementCounter::LEVEL, player.level);
+    }
+    addToCounter(AchievementCounter::ENEMIES_DEFEATED, 1);
+    addToCounter(AchievementCounter::FLOORS_CLEARED, 1);
+    addToCounter(AchievementCounter::GOLD_EARNED, goldGained);
+    
+    bool bossFloor = currentFloor >= data->dungeonSizeInfo.at(currentDungeonSize).floors;
+    rollLoot(bossFloor);
+    
+    // Check if dungeon is completed
+    if (bossFloor) {
+        result.dungeonCompleted = true;
+        player.dungeonsCompleted++;
+        logEvent(CombatEventKind::DUNGEON_COMPLETED, static_cast<std::uint8_t>(currentBiome),
+                 static_cast<int>(currentDungeonSize));
+        
+        // The final floor is always a boss
+        addToCounter(static_cast<AchievementCounter>(
+            static_cast<int>(AchievementCounter::BOSSES_FOREST) + static_cast<int>(currentBiome)), 1);
+        addToCounter(static_cast<AchievementCounter>(
+            static_cast<int>(AchievementCounter::CLEARS_SMALL) + static_cast<int>(currentDungeonSize)), 1);
+        addToCounter(AchievementCounter::DUNGEONS_COMPLETED, 1);
+        if (damageTakenThisRun == 0) {
+            addToCounter(AchievementCounter::NO_DAMAGE_CLEARS, 1);
+        }
+        currentFloor = 0;
+        currentEnemy = nullptr;
+        inDungeon = false;
+        autoBattle = false;
+        player.status.clear();
+    } else {
+        // Advance to next floor; the player's effects carry over
+        logEvent(CombatEventKind::FLOOR_CLEARED);
+        currentFloor++;
+        result.floorCleared = true;
+        player.heal(static_cast<int>(player.effectiveMaxHealth * 0.3));
+        spawnEnemy();
+    }
+}
+
+void GameState::defeatPlayer(CombatResult& result) {
+    result.playerDied = true;
+    logEvent(CombatEventKind::PLAYER_DIED);
+    addToCounter(AchievementCounter::DEATHS, 1);
+    // Reset to town
+    currentFloor = 0;
+    currentEnemy = nullptr;
+    inDungeon = false;
+    autoBattle = false;
+    player.status.clear();
+    player.fullHeal();
 }
 
 bool GameState::upgradeStat(const std::string& stat) {
@@ -241,25 +545,43 @@ bool GameState::upgradeStat(const std::string& stat) {
         return false;
     }
     
+    int amount = getUpgradeAmount(stat);
     if (stat == "health") {
-        player.maxHealth += 20;
-        player.health = player.maxHealth;
+        player.maxHealth += amount;
     } else if (stat == "attack") {
-        player.attack += 5;
+        player.attack += amount;
     } else if (stat == "defense") {
-        player.defense += 2;
+        player.defense += amount;
+    }
+    player.recalculateStats();
+    if (stat == "health") {
+        player.health = player.effectiveMaxHealth;
     }
+    addToCounter(AchievementCounter::UPGRADES_BOUGHT, 1);
     
     return true;
 }
 
 int GameState::getUpgradeCost(const std::string& stat) const {
+    const BalanceSheet& balance = BalanceSheet::instance();
+    if (stat == "health") {
+        return balance.evaluateInt(BalanceFormula::UPGRADE_HEALTH_COST, player.balanceInputs());
+    } else if (stat == "attack") {
+        return balance.evaluateInt(BalanceFormula::UPGRADE_ATTACK_COST, player.balanceInputs());
+    } else if (stat == "defense") {
+        return balance.evaluateInt(BalanceFormula::UPGRADE_DEFENSE_COST, player.balanceInputs());
+    }
+    return 0;
+}
+
+int GameState::getUpgradeAmount(const std::string& stat) const {
+    const BalanceSheet& balance = BalanceSheet::instance();
     if (stat == "health") {
-        return static_cast<int>(50 * std::pow(1.5, player.maxHealth / 20 - 5));
+        return balance.evaluateInt(BalanceFormula::UPGRADE_HEALTH, player.balanceInputs());
     } else if (stat == "attack") {
-        return static_cast<int>(100 * std::pow(1.5, player.attack / 5 - 2));
+        return balance.evaluateInt(BalanceFormula::UPGRADE_ATTACK, player.balanceInputs());
     } else if (stat == "defense") {
-        return static_cast<int>(80 * std::pow(1.5, player.defense / 2 - 2));
+        return balance.evaluateInt(BalanceFormula::UPGRADE_DEFENSE, player.balanceInputs());
     }
     return 0;
 }
@@ -269,19 +591,118 @@ void GameState::toggleAutoBattle() {
 }
 
 void GameState::fleeDungeon() {
+    if (inDungeon) {
+        logEvent(CombatEventKind::FLED);
+    }
     currentFloor = 0;
     currentEnemy = nullptr;
     inDungeon = false;
     autoBattle = false;
+    player.status.clear();
     player.fullHeal();
 }
 
+void GameState::rollLoot(bool boss) {
+    if (simulated) {
+        return;
+    }
+    
+    std::uniform_int_distribution<> percent(0, 99);
+    if (!boss && percent(*rng) >= LOOT_DROP_CHANCE) {
+        return;
+    }
+    
+    double difficulty = data->dungeonSizeInfo.at(currentDungeonSize).difficultyMultiplier;
+    Item item = generateItem(static_cast<int>(currentFloor * difficulty), boss, *rng);
+    if (inventory->isFull()) {
+        // Checked before write() so a full, shared inventory is never cloned
+        player.gold += item.salvageValue();
+        logEvent(CombatEventKind::ITEM_SALVAGED, 0, item.salvageValue());
+        return;
+    }
+    
+    inventory.write().add(item);
+    logEvent(CombatEventKind::ITEM_DROPPED, static_cast<std::uint8_t>(item.rarity),
+             static_cast<int>(item.slot), item.itemLevel);
+    addToCounter(AchievementCounter::ITEMS_FOUND, 1);
+}
+
+Inventory& GameState::editInventory() {
+    return inventory.write();
+}
+
+int GameState::equipBest(GearRank rank) {
+    int changed = inventory.write().equipBest(rank);
+    player.applyEquipment(inventory->bonuses());
+    resolveElementalHit();
+    return changed;
+}
+
+int GameState::salvageWorseItems(GearRank rank) {
+    int gold = 0;
+    int removed = inventory.write().salvageWorse(rank, gold);
+    player.gold += gold;
+    return removed;
+}
+
+GameState GameState::fork() const {
+    GameState copy = *this;
+    copy.combatLog = nullptr;
+    copy.simulated = true;
+    return copy;
+}
+
+RunProjection GameState::projectRun(Biome biome, DungeonSize size, int trials) const {
+    RunProjection projection = {trials, 0.0, 0.0, 0.0};
+    if (trials <= 0) {
+        return projection;
+    }
+    
+    int clears = 0;
+    long long floors = 0;
+    long long gold = 0;
+    for (int i = 0; i < trials; i++) {
+        // Each trial forks this state; the original is never touched
+        GameState sim = fork();
+        sim.startDungeon(biome, size);
+        while (sim.isInDungeon()) {
+            if (sim.attackEnemy().dungeonCompleted) {
+                clears++;
+            }
+        }
+        floors += sim.player.floorsCleared - player.floorsCleared;
+        gold += sim.player.gold - player.gold;
+    }
+    
+    projection.clearRate = static_cast<double>(clears) / trials;
+    projection.avgFloorsCleared = static_cast<double>(floors) / trials;
+    projection.avgGold = static_cast<double>(gold) / trials;
+    return projection;
+}
+
 bool GameState::saveGame(const std::string& filename) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         return false;
     }
     
+    writeSave(file);
+    file.close();
+    return true;
+}
+
+bool GameState::loadGame(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    bool loaded = readSave(file);
+    file.close();
+    return loaded;
+}
+
+void GameState::writeSave(std::ostream& file) const {
     file << "{\n";
     file << "  \"player\": {\n";
     file << "    \"name\": \"" << player.name << "\",\n";
@@ -296,28 +717,156 @@ bool GameState::saveGame(const std::string& filename) {
     file << "    \"floorsCleared\": " << player.floorsCleared << ",\n";
     file << "    \"dungeonsCompleted\": " << player.dungeonsCompleted << "\n";
     file << "  },\n";
+    
+    file << "  \"achievementCounters\": [";
+    for (size_t c = 0; c < ACHIEVEMENT_COUNTER_COUNT; c++) {
+        file << (c > 0 ? ", " : "") << achievements.get(static_cast<AchievementCounter>(c));
+    }
+    file << "],\n";
+    
+    const AchievementCatalog& catalog = AchievementCatalog::instance();
+    file << "  \"achievements\": [";
+    bool first = true;
+    for (size_t id = 0; id < catalog.all().size(); id++) {
+        if (achievements.isUnlocked(id)) {
+            file << (first ? "" : ", ") << "\"" << catalog.get(id).key << "\"";
+            first = false;
+        }
+    }
+    file << "],\n";
+    
+    // Items are written compacted; equipped entries index into this list
+    std::vector<std::uint32_t> ids = inventory->liveIds();
+    file << "  \"equipped\": [";
+    for (size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+        std::uint32_t id = inventory->equipped(static_cast<EquipSlot>(s));
+        long position = -1;
+        if (id != Inventory::NO_ITEM) {
+            position = std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+        }
+        file << (s > 0 ? ", " : "") << position;
+    }
+    file << "],\n";
+    
+    // Items are packed per block of ids, so a drop or salvage only changes
+    // the one line holding that id and slot history deltas stay small
+    file << "  \"items\": [\n";
+    std::size_t blocks = ids.empty() ? 0 : ids.back() / SAVE_ITEMS_PER_LINE + 1;
+    std::vector<Item> block;
+    for (size_t b = 0, next = 0; b < blocks; b++) {
+        block.clear();
+        while (next < ids.size() && ids[next] / SAVE_ITEMS_PER_LINE == b) {
+            block.push_back(inventory->get(ids[next++]));
+        }
+        file << "    \"" << encodeItems(block) << (b + 1 < blocks ? "\",\n" : "\"\n");
+    }
+    file << "  ],\n";
     file << "  \"currentFloor\": " << currentFloor << ",\n";
     file << "  \"autoBattle\": " << (autoBattle ? "true" : "false") << ",\n";
     file << "  \"inDungeon\": " << (inDungeon ? "true" : "false") << "\n";
     file << "}\n";
-    
-    file.close();
-    return true;
 }
 
-bool GameState::loadGame(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        return false;
+// Parses one "[slot,rarity,level,affix...]" line of the older text
+// "inventory" array into the pool.
+// Returns the new id, or NO_ITEM for an invalid entry so positions stay aligned.
+static std::uint32_t parseSavedItem(const std::string& line, Inventory& items) {
+    std::vector<int> fields;
+    std::istringstream values(line.substr(1, line.find(']') - 1));
+    std::string value;
+    while (std::getline(values, value, ',')) {
+        fields.push_back(std::stoi(value));
     }
     
+    size_t affixCount = fields.size() < 3 ? 0 : fields.size() - 3;
+    if (fields.size() < 4 || affixCount > MAX_AFFIXES ||
+        fields[0] < 0 || fields[0] >= static_cast<int>(EQUIP_SLOT_COUNT) ||
+        fields[1] < 0 || fields[1] > static_cast<int>(Rarity::LEGENDARY)) {
+        return Inventory::NO_ITEM;
+    }
+    
+    Item item = {};
+    item.slot = static_cast<EquipSlot>(fields[0]);
+    item.rarity = static_cast<Rarity>(fields[1]);
+    item.itemLevel = static_cast<std::uint16_t>(std::max(1, std::min(fields[2], 0xFFFF)));
+    item.affixCount = static_cast<std::uint8_t>(affixCount);
+    for (size_t a = 0; a < affixCount; a++) {
+        std::uint16_t affix = static_cast<std::uint16_t>(fields[3 + a]);
+        if (affixStat(affix) >= AffixStat::COUNT) {
+            return Inventory::NO_ITEM;
+        }
+        item.affixes[a] = affix;
+    }
+    return items.add(item);
+}
+
+bool GameState::readSave(std::istream& file) {
+    std::array<std::int64_t, ACHIEVEMENT_COUNTER_COUNT> counters = {};
+    std::vector<std::string> unlockedKeys;
+    bool hasCounters = false;
+    std::vector<long> equippedPositions;
+    std::vector<std::uint32_t> loadedIds;
+    std::vector<Item> packedItems;
+    bool inInventory = false;
+    bool inItems = false;
+    inventory = CowPtr<Inventory>(std::make_shared<Inventory>());
+    
     // Simple JSON parsing (basic implementation)
     std::string line;
     while (std::getline(file, line)) {
+        // Packed item lines are the bulk of a big save, so they are read in
+        // place instead of being stripped like the other lines
+        if (inItems) {
+            size_t start = line.find('"');
+            if (start == std::string::npos) {
+                inItems = false;
+                continue;
+            }
+            size_t end = line.find('"', start + 1);
+            if (end == std::string::npos || !decodeItems(line.substr(start + 1, end - start - 1), packedItems)) {
+                return false;
+            }
+            continue;
+        }
+        
         // Remove whitespace and quotes
         line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
         
-        if (line.find("\"level\":") != std::string::npos) {
+        if (inInventory) {
+            if (line.empty() || line[0] != '[') {
+                inInventory = false;
+                continue;
+            }
+            loadedIds.push_back(parseSavedItem(line, inventory.write()));
+        } else if (line.find("\"items\":") != std::string::npos) {
+            packedItems.reserve(Inventory::MAX_ITEMS);
+            inItems = true;
+        } else if (line.find("\"inventory\":") != std::string::npos) {
+            inInventory = true;
+        } else if (line.find("\"equipped\":") != std::string::npos) {
+            std::istringstream values(line.substr(line.find("[") + 1));
+            std::string value;
+            while (std::getline(values, value, ',')) {
+                equippedPositions.push_back(std::stol(value));
+            }
+        } else if (line.find("\"achievementCounters\":") != std::string::npos) {
+            std::istringstream values(line.substr(line.find("[") + 1));
+            std::string value;
+            for (size_t c = 0; c < ACHIEVEMENT_COUNTER_COUNT && std::getline(values, value, ','); c++) {
+                counters[c] = std::stoll(value);
+            }
+            hasCounters = true;
+        } else if (line.find("\"achievements\":") != std::string::npos) {
+            size_t pos = line.find("[");
+            while ((pos = line.find('"', pos)) != std::string::npos) {
+                size_t end = line.find('"', pos + 1);
+                if (end == std::string::npos) {
+                    break;
+                }
+                unlockedKeys.push_back(line.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+            }
+        } else if (line.find("\"level\":") != std::string::npos) {
             player.level = std::stoi(line.substr(line.find(":") + 1, line.find(",") - line.find(":") - 1));
         } else if (line.find("\"health\":") != std::string::npos) {
             player.health = std::stoi(line.substr(line.find(":") + 1, line.find(",") - line.find(":") - 1));
@@ -340,16 +889,50 @@ bool GameState::loadGame(const std::string& filename) {
         }
     }
     
-    file.close();
+    // Saves from before achievements existed seed what the player stats imply
+    if (!hasCounters) {
+        auto seed = [&](AchievementCounter counter, std::int64_t value) {
+            counters[static_cast<size_t>(counter)] = value;
+        };
+        seed(AchievementCounter::FLOORS_CLEARED, player.floorsCleared);
+        seed(AchievementCounter::ENEMIES_DEFEATED, player.floorsCleared);
+        seed(AchievementCounter::DUNGEONS_COMPLETED, player.dungeonsCompleted);
+        seed(AchievementCounter::LEVEL, player.level);
+    }
+    achievements.restore(counters, unlockedKeys);
+    
+    if (!packedItems.empty()) {
+        loadedIds = inventory.write().addAll(packedItems);
+    }
+    for (long position : equippedPositions) {
+        if (position >= 0 && position < static_cast<long>(loadedIds.size())) {
+            inventory.write().equip(loadedIds[position]);
+        }
+    }
+    player.applyEquipment(inventory->bonuses());
+    resolveElementalHit();
+    
     return true;
 }
 
 std::string GameState::getBiomeName(Biome biome) const {
-    return biomeNames.at(biome);
+    return data->biomeNames.at(biome);
+}
+
+std::string GameState::getEnemyTypeName(Biome biome, int index) const {
+    const auto& types = data->enemyTypes.at(biome);
+    if (index < 0 || index >= static_cast<int>(types.size())) {
+        return "Unknown";
+    }
+    return types[index];
+}
+
+const BiomeAffinity& GameState::getBiomeAffinity(Biome biome) const {
+    return data->affinities.at(biome);
 }
 
 DungeonSizeInfo GameState::getDungeonSizeInfo(DungeonSize size) const {
-    return dungeonSizeInfo.at(size);
+    return data->dungeonSizeInfo.at(size);
 }
 
 std::vector<Biome> GameState::getAllBiomes() const {
@@ -360,6 +943,40 @@ std::vector<DungeonSize> GameState::getAllDungeonSizes() const {
     return {DungeonSize::SMALL, DungeonSize::MEDIUM, DungeonSize::LARGE, DungeonSize::EPIC};
 }
 
+// StateHistory implementation
+StateHistory::StateHistory(size_t capacity)
+    : ring(std::max<size_t>(1, capacity)), logMarks(ring.size()), head(0), count(0) {}
+
+void StateHistory::record(const GameState& state) {
+    // Copy-assigning into a preallocated slot keeps recording allocation-free
+    ring[head] = state;
+    logMarks[head] = state.getCombatLog() ? state.getCombatLog()->totalRecorded() : 0;
+    head = (head + 1) % ring.size();
+    count = std::min(count + 1, ring.size());
+}
+
+bool StateHistory::rewind(GameState& state, size_t steps) {
+    if (steps == 0 || steps > count) {
+        return false;
+    }
+    head = (head + ring.size() - steps) % ring.size();
+    count -= steps;
+    state = ring[head];
+    if (CombatLog* log = state.getCombatLog()) {
+        log->truncate(logMarks[head]);
+    }
+    return true;
+}
+
+size_t StateHistory::size() const {
+    return count;
+}
+
+void StateHistory::clear() {
+    head = 0;
+    count = 0;
+}
+
 // UI functions
 void clearScreen() {
 #ifdef _WIN32
@@ -379,9 +996,35 @@ void printHeader(const std::string& text) {
 
 void printPlayerStats(const Player& player) {
     std::cout << "\n📊 Player Stats:\n";
+    auto gearText = [](int bonus) {
+        return bonus > 0 ? " (+" + std::to_string(bonus) + " gear)" : std::string();
+    };
     std::cout << "  Level: " << player.level << " | HP: " << player.health 
-              << "/" << player.maxHealth << "\n";
-    std::cout << "  Attack: " << player.attack << " | Defense: " << player.defense << "\n";
+              << "/" << player.effectiveMaxHealth << gearText(player.gear.maxHealth) << "\n";
+    std::cout << "  Attack: " << player.effectiveAttack << gearText(player.gear.attack)
+              << " | Defense: " << player.effectiveDefense << gearText(player.gear.defense) << "\n";
+    if (player.gear.goldFindPercent > 0 || player.gear.expBonusPercent > 0) {
+        std::cout << "  Gear Bonus: +" << player.gear.goldFindPercent << "% gold | +"
+                  << player.gear.expBonusPercent << "% exp\n";
+    }
+    if (player.gear.elementMask != 0) {
+        std::cout << "  Elemental Damage:";
+        for (size_t e = 1; e < ELEMENT_COUNT; e++) {
+            if (player.gear.elementDamage[e] > 0) {
+                std::cout << " +" << player.gear.elementDamage[e] << " "
+                          << getElementName(static_cast<Element>(e));
+            }
+        }
+        std::cout << "\n";
+    }
+    std::string resistances = describeResistances(player.resistPercent);
+    if (!resistances.empty()) {
+        std::cout << "  Gear: " << resistances << "\n";
+    }
+    std::string effects = describeStatusEffects(player.status);
+    if (!effects.empty()) {
+        std::cout << "  Status: " << effects << "\n";
+    }
     std::cout << "  Gold: " << player.gold << " | EXP: " << player.experience 
               << "/" << player.expToNextLevel << "\n";
     std::cout << "  Floors Cleared: " << player.floorsCleared 
@@ -391,7 +1034,16 @@ void printPlayerStats(const Player& player) {
 void printEnemyStats(const Enemy& enemy) {
     std::cout << "\n⚔️  Enemy: " << enemy.name << "\n";
     std::cout << "  HP: " << enemy.health << "/" << enemy.maxHealth << "\n";
-    std::cout << "  Attack: " << enemy.attack << " | Defense: " << enemy.defense << "\n";
+    std::cout << "  Attack: " << enemy.attack << " (" << getElementName(enemy.element) << ")"
+              << " | Defense: " << enemy.defense << "\n";
+    std::string resistances = describeResistances(enemy.resistPercent);
+    if (!resistances.empty()) {
+        std::cout << "  Affinity: " << resistances << "\n";
+    }
+    std::string effects = describeStatusEffects(enemy.status);
+    if (!effects.empty()) {
+        std::cout << "  Status: " << effects << "\n";
+    }
 }
 
 // Menu functions
@@ -406,7 +1058,10 @@ std::string mainMenu(const GameState& game) {
     std::cout << "  3. View Statistics\n";
     std::cout << "  4. Save Game\n";
     std::cout << "  5. Load Game\n";
-    std::cout << "  6. Exit\n";
+    std::cout << "  6. Combat Log\n";
+    std::cout << "  7. Inventory\n";
+    std::cout << "  8. Farming Queue\n";
+    std::cout << "  9. Exit\n";
     
     std::string choice;
     std::cout << "\nChoose an option: ";
@@ -414,6 +1069,18 @@ std::string mainMenu(const GameState& game) {
     return choice;
 }
 
+static std::string describeAffinity(const BiomeAffinity& affinity) {
+    if (affinity.element == Element::PHYSICAL && affinity.inflicts == 0) {
+        return "";
+    }
+    std::string text = " - " + getElementName(affinity.element) + " attacks";
+    for (std::uint32_t mask = affinity.inflicts; mask != 0; mask &= mask - 1) {
+        text += ", inflict " + getStatusEffectName(static_cast<StatusEffect>(lowestSetBit(mask)));
+    }
+    std::string resistances = describeResistances(affinity.resistPercent);
+    return resistances.empty() ? text : text + "; " + resistances;
+}
+
 bool dungeonSelectionMenu(GameState& game, Biome& outBiome, DungeonSize& outSize) {
     clearScreen();
     printHeader("🗺️  SELECT DUNGEON");
@@ -422,7 +1089,8 @@ bool dungeonSelectionMenu(GameState& game, Biome& outBiome, DungeonSize& outSize
     std::cout << "\n🌍 Select Biome:\n";
     auto biomes = game.getAllBiomes();
     for (size_t i = 0; i < biomes.size(); i++) {
-        std::cout << "  " << (i + 1) << ". " << game.getBiomeName(biomes[i]) << "\n";
+        std::cout << "  " << (i + 1) << ". " << game.getBiomeName(biomes[i])
+                  << describeAffinity(game.getBiomeAffinity(biomes[i])) << "\n";
     }
     
     std::cout << "\n0. Back to Main Menu\n";
@@ -478,6 +1146,8 @@ bool dungeonSelectionMenu(GameState& game, Biome& outBiome, DungeonSize& outSize
 }
 
 void combatMenu(GameState& game) {
+    StateHistory history(REWIND_DEPTH);
+    
     while (game.getCurrentEnemy() && game.getCurrentEnemy()->isAlive() && 
            game.getPlayer().isAlive() && game.isInDungeon()) {
         
@@ -493,6 +1163,10 @@ void combatMenu(GameState& game) {
         std::cout << "  1. Attack\n";
         std::cout << "  2. Auto Battle (toggle)\n";
         std::cout << "  3. Flee (return to town)\n";
+        if (history.size() > 0) {
+            std::cout << "  4. Rewind last action (" << history.size() << " available)\n";
+        }
+        std::cout << "  5. View combat log\n";
         
         std::string choice;
         if (game.isAutoBattle()) {
@@ -505,41 +1179,30 @@ void combatMenu(GameState& game) {
         }
         
         if (choice == "1") {
+            history.record(game);
+            const CombatLog* log = game.getCombatLog();
+            std::uint64_t mark = log ? log->totalRecorded() : 0;
             auto result = game.attackEnemy();
             
             if (!game.isAutoBattle()) {
-                std::cout << "\n💥 You dealt " << result.playerDamage << " damage!\n";
-                
-                if (result.enemyDefeated) {
-                    std::cout << "🎉 Enemy defeated! +" << game.getCurrentEnemy()->goldReward 
-                             << " gold, +" << game.getCurrentEnemy()->expReward << " exp\n";
-                    
-                    if (result.dungeonCompleted) {
-                        std::cout << "\n🏆 DUNGEON COMPLETED! 🏆\n";
-                        std::cout << "\nPress Enter to continue...";
-                        std::cin.get();
-                        return;
-                    } else if (result.floorCleared) {
-                        std::cout << "\n✨ Floor " << (game.getCurrentFloor() - 1) 
-                                 << " cleared! Healing 30%...\n";
-                        std::cout << "\nPress Enter to continue to next floor...";
-                        std::cin.get();
+                // Format only this exchange's events, straight from the log
+                std::cout << "\n";
+                if (log) {
+                    for (size_t i = log->size() - log->countSince(mark); i < log->size(); i++) {
+                        std::cout << formatCombatEvent(log->at(i), game) << "\n";
                     }
-                } else {
-                    if (result.enemyDamage > 0) {
-                        std::cout << "💔 Enemy dealt " << result.enemyDamage << " damage!\n";
-                    }
-                    
-                    if (result.playerDied) {
-                        std::cout << "\n💀 You have been defeated! Returning to town...\n";
-                        std::cout << "\nPress Enter to continue...";
-                        std::cin.get();
-                        return;
-                    }
-                    
+                }
+                
+                if (result.dungeonCompleted || result.playerDied) {
                     std::cout << "\nPress Enter to continue...";
                     std::cin.get();
+                    return;
+                } else if (result.floorCleared) {
+                    std::cout << "\nPress Enter to continue to next floor...";
+                } else {
+                    std::cout << "\nPress Enter to continue...";
                 }
+                std::cin.get();
             }
         } else if (choice == "2") {
             game.toggleAutoBattle();
@@ -552,20 +1215,118 @@ void combatMenu(GameState& game) {
         } else if (choice == "3") {
             game.fleeDungeon();
             return;
+        } else if (choice == "4") {
+            if (history.rewind(game)) {
+                std::cout << "\n⏪ Rewound one action.\n";
+            } else {
+                std::cout << "\n❌ Nothing to rewind!\n";
+            }
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+        } else if (choice == "5") {
+            combatLogMenu(game);
         }
     }
 }
 
+void combatLogMenu(const GameState& game) {
+    const CombatLog* log = game.getCombatLog();
+    const size_t pageSize = 15;
+    size_t page = 0;
+    
+    while (true) {
+        clearScreen();
+        printHeader("📜 COMBAT LOG");
+        
+        if (!log || log->size() == 0) {
+            std::cout << "\nNo combat recorded yet.\n";
+            std::cout << "\nPress Enter to return...";
+            std::cin.get();
+            return;
+        }
+        
+        // Page 0 holds the newest events; only the visible page is formatted
+        size_t pages = (log->size() + pageSize - 1) / pageSize;
+        page = std::min(page, pages - 1);
+        size_t end = log->size() - page * pageSize;
+        size_t start = end > pageSize ? end - pageSize : 0;
+        std::uint64_t firstSequence = log->totalRecorded() - log->size() + 1;
+        
+        std::cout << "\n";
+        for (size_t i = start; i < end; i++) {
+            std::cout << "  #" << (firstSequence + i) << " "
+                      << formatCombatEvent(log->at(i), game) << "\n";
+        }
+        std::cout << "\nPage " << (page + 1) << "/" << pages << " (newest first) - "
+                  << log->size() << " of " << log->totalRecorded() << " events kept\n";
+        
+        std::cout << "\n  n. Older\n";
+        std::cout << "  p. Newer\n";
+        std::cout << "  e. Export to combat_log.txt\n";
+        std::cout << "  0. Back\n";
+        
+        std::string choice;
+        std::cout << "\nChoose an option: ";
+        if (!std::getline(std::cin, choice) || choice == "0") {
+            return;
+        } else if (choice == "n" && page + 1 < pages) {
+            page++;
+        } else if (choice == "p" && page > 0) {
+            page--;
+        } else if (choice == "e") {
+            if (exportCombatLog(*log, game, "combat_log.txt")) {
+                std::cout << "\n💾 Exported " << log->size() << " events to combat_log.txt\n";
+            } else {
+                std::cout << "\n❌ Failed to export combat log!\n";
+            }
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+        }
+    }
+}
+
+static void printProjection(const RunProjection& projection) {
+    std::cout << std::fixed << std::setprecision(1)
+              << static_cast<int>(projection.clearRate * 100 + 0.5) << "% clear, "
+              << projection.avgFloorsCleared << " floors, "
+              << static_cast<int>(projection.avgGold) << " gold avg";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// Forks the state, buys the upgrade as if affordable and simulates ahead
+static void printUpgradePreview(const GameState& game, const std::string& stat) {
+    GameState upgraded = game.fork();
+    upgraded.getPlayer().gold += upgraded.getUpgradeCost(stat);
+    upgraded.upgradeStat(stat);
+    std::cout << "     ↳ ";
+    printProjection(upgraded.projectRun(game.getCurrentBiome(), game.getCurrentDungeonSize(),
+                                        PREVIEW_TRIALS));
+    std::cout << "\n";
+}
+
 void upgradeMenu(GameState& game) {
     while (true) {
         clearScreen();
         printHeader("⬆️  UPGRADE STATS");
         printPlayerStats(game.getPlayer());
         
+        std::string dungeonName = game.getDungeonSizeInfo(game.getCurrentDungeonSize()).displayName +
+                                  " " + game.getBiomeName(game.getCurrentBiome());
+        std::cout << "\n🔮 Projected " << dungeonName << " run now: ";
+        printProjection(game.projectRun(game.getCurrentBiome(), game.getCurrentDungeonSize(),
+                                        PREVIEW_TRIALS));
+        std::cout << "\n";
+        
         std::cout << "\n💰 Upgrades Available:\n";
-        std::cout << "  1. Max Health +20 (Cost: " << game.getUpgradeCost("health") << " gold)\n";
-        std::cout << "  2. Attack +5 (Cost: " << game.getUpgradeCost("attack") << " gold)\n";
-        std::cout << "  3. Defense +2 (Cost: " << game.getUpgradeCost("defense") << " gold)\n";
+        std::cout << "  1. Max Health +" << game.getUpgradeAmount("health")
+                  << " (Cost: " << game.getUpgradeCost("health") << " gold)\n";
+        printUpgradePreview(game, "health");
+        std::cout << "  2. Attack +" << game.getUpgradeAmount("attack")
+                  << " (Cost: " << game.getUpgradeCost("attack") << " gold)\n";
+        printUpgradePreview(game, "attack");
+        std::cout << "  3. Defense +" << game.getUpgradeAmount("defense")
+                  << " (Cost: " << game.getUpgradeCost("defense") << " gold)\n";
+        printUpgradePreview(game, "defense");
         std::cout << "\n  0. Back to Main Menu\n";
         
         std::string choice;
@@ -612,6 +1373,377 @@ void statisticsMenu(const GameState& game) {
     std::cout << "  Total Dungeons Completed: " << game.getPlayer().dungeonsCompleted << "\n";
     std::cout << "  Current Level: " << game.getPlayer().level << "\n";
     
+    // One line per counter: best unlocked tier and progress to the next
+    const AchievementCatalog& catalog = AchievementCatalog::instance();
+    const AchievementTracker& tracker = game.getAchievements();
+    std::cout << "\n🏅 Achievements (" << tracker.unlockedCount() << "/" << catalog.all().size()
+              << " unlocked):\n";
+    for (size_t c = 0; c < ACHIEVEMENT_COUNTER_COUNT; c++) {
+        AchievementCounter counter = static_cast<AchievementCounter>(c);
+        int last = tracker.lastFor(counter);
+        int next = tracker.nextFor(counter);
+        
+        std::cout << "  " << (last >= 0 ? "✅ " + catalog.get(last).name : "⬜");
+        if (next >= 0) {
+            std::cout << (last >= 0 ? " → " : " ") << "Next: " << catalog.get(next).name << " ("
+                      << tracker.get(counter) << "/" << catalog.get(next).threshold << ")";
+        } else {
+            std::cout << " (complete)";
+        }
+        std::cout << "\n";
+    }
+    
     std::cout << "\nPress Enter to return...";
     std::cin.get();
 }
+
+
+static std::string formatTimestamp(std::int64_t timestamp) {
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm* local = std::localtime(&time);
+    if (!local) {
+        return "unknown";
+    }
+    std::ostringstream out;
+    out << std::put_time(local, "%Y-%m-%d %H:%M:%S");
+    return out.str();
+}
+
+static void printSlotList(const SaveSlotManager& slots) {
+    const auto& list = slots.listSlots();
+    if (list.empty()) {
+        std::cout << "  (no save slots yet)\n";
+    }
+    for (size_t i = 0; i < list.size(); i++) {
+        const auto& info = list[i];
+        std::cout << "  " << (i + 1) << ". " << info.name
+                  << " - Lv " << info.level
+                  << " | Floors " << info.floorsCleared
+                  << " | Dungeons " << info.dungeonsCompleted
+                  << " | " << formatTimestamp(info.timestamp)
+                  << " (" << info.snapshots << " snapshots)\n";
+    }
+}
+
+// Returns the chosen slot name, or an empty string to go back
+static std::string chooseSlot(const SaveSlotManager& slots, const std::string& choice) {
+    try {
+        int slotIdx = std::stoi(choice) - 1;
+        if (slotIdx >= 0 && slotIdx < static_cast<int>(slots.listSlots().size())) {
+            return slots.listSlots()[slotIdx].name;
+        }
+    } catch (...) {
+    }
+    return "";
+}
+
+void saveSlotMenu(const GameState& game, SaveSlotManager& slots) {
+    clearScreen();
+    printHeader("💾 SAVE GAME");
+    
+    std::cout << "\n📂 Save Slots:\n";
+    printSlotList(slots);
+    std::cout << "\n  N. New slot\n";
+    std::cout << "  0. Back to Main Menu\n";
+    
+    std::string choice;
+    std::cout << "\nChoose a slot: ";
+    std::getline(std::cin, choice);
+    
+    if (choice == "0" || choice.empty()) {
+        return;
+    }
+    
+    std::string slot;
+    if (choice == "n" || choice == "N") {
+        std::cout << "Slot name (letters, digits, - or _): ";
+        std::getline(std::cin, slot);
+        if (!SaveSlotManager::isValidSlotName(slot)) {
+            std::cout << "\n❌ Invalid slot name!\n";
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+            return;
+        }
+    } else {
+        slot = chooseSlot(slots, choice);
+        if (slot.empty()) {
+            return;
+        }
+    }
+    
+    if (slots.saveSnapshot(slot, game)) {
+        std::cout << "\n💾 Game saved to slot '" << slot << "'!\n";
+    } else {
+        std::cout << "\n❌ Failed to save game!\n";
+    }
+    std::cout << "\nPress Enter to continue...";
+    std::cin.get();
+}
+
+bool loadSlotMenu(GameState& game, const SaveSlotManager& slots) {
+    clearScreen();
+    printHeader("📂 LOAD GAME");
+    
+    std::cout << "\n📂 Save Slots:\n";
+    printSlotList(slots);
+    std::cout << "\n  0. Back to Main Menu\n";
+    
+    std::string choice;
+    std::cout << "\nChoose a slot: ";
+    std::getline(std::cin, choice);
+    
+    std::string slot = chooseSlot(slots, choice);
+    if (slot.empty()) {
+        return false;
+    }
+    
+    auto snapshots = slots.listSnapshots(slot);
+    if (snapshots.empty()) {
+        return false;
+    }
+    
+    // Newest first; older snapshots stay reachable by number
+    clearScreen();
+    printHeader("📂 " + slot + " - SELECT SNAPSHOT");
+    const int shown = std::min(10, static_cast<int>(snapshots.size()));
+    std::cout << "\n🕒 Snapshots (1 = latest):\n";
+    for (int i = 0; i < shown; i++) {
+        const auto& info = snapshots[snapshots.size() - 1 - i];
+        std::cout << "  " << (i + 1) << ". " << formatTimestamp(info.timestamp) << "\n";
+    }
+    if (static_cast<int>(snapshots.size()) > shown) {
+        std::cout << "  ... enter " << (shown + 1) << "-" << snapshots.size()
+                  << " for older snapshots\n";
+    }
+    std::cout << "\n  0. Back\n";
+    std::cout << "\nChoose a snapshot (Enter for latest): ";
+    std::getline(std::cin, choice);
+    
+    int age = 1;
+    if (!choice.empty()) {
+        try {
+            age = std::stoi(choice);
+        } catch (...) {
+            return false;
+        }
+    }
+    if (age < 1 || age > static_cast<int>(snapshots.size())) {
+        return false;
+    }
+    
+    return slots.loadSnapshot(slot, static_cast<int>(snapshots.size()) - age, game);
+}
+
+void inventoryMenu(GameState& game) {
+    static const GearRank equipRanks[] = {GearRank::ATTACK, GearRank::DEFENSE, GearRank::HEALTH,
+                                          GearRank::POWER};
+    
+    while (true) {
+        clearScreen();
+        const Inventory& items = game.getInventory();
+        printHeader("🎒 INVENTORY (" + std::to_string(items.size()) + "/" +
+                    std::to_string(Inventory::MAX_ITEMS) + " items)");
+        printPlayerStats(game.getPlayer());
+        
+        std::cout << "\n🛡️  Equipped:\n";
+        for (size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+            EquipSlot slot = static_cast<EquipSlot>(s);
+            std::uint32_t id = items.equipped(slot);
+            std::cout << "  " << getSlotName(slot) << ": "
+                      << (id == Inventory::NO_ITEM ? "(empty)" : describeItem(items.get(id)))
+                      << " [" << items.countInSlot(slot) << " owned]\n";
+        }
+        
+        std::cout << "\n🎒 Options:\n";
+        std::cout << "  1. Equip best for attack\n";
+        std::cout << "  2. Equip best for defense\n";
+        std::cout << "  3. Equip best for health\n";
+        std::cout << "  4. Equip best overall\n";
+        std::cout << "  5. Auto-salvage everything worse than equipped\n";
+        std::cout << "\n  0. Back to Main Menu\n";
+        
+        std::string choice;
+        std::cout << "\nChoose an option: ";
+        if (!std::getline(std::cin, choice) || choice == "0") {
+            return;
+        }
+        
+        if (choice >= "1" && choice <= "4" && choice.size() == 1) {
+            int changed = game.equipBest(equipRanks[choice[0] - '1']);
+            std::cout << "\n✅ Equipped " << changed << " new item(s).\n";
+        } else if (choice == "5") {
+            int goldBefore = game.getPlayer().gold;
+            int removed = game.salvageWorseItems(GearRank::POWER);
+            std::cout << "\n♻️  Salvaged " << removed << " item(s) for "
+                      << (game.getPlayer().gold - goldBefore) << " gold.\n";
+        } else {
+            continue;
+        }
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+}
+
+static std::string formatDuration(double seconds) {
+    long long total = static_cast<long long>(seconds);
+    std::ostringstream out;
+    out << (total / 3600) << "h " << std::setfill('0') << std::setw(2) << (total / 60 % 60)
+        << "m " << std::setw(2) << (total % 60) << "s";
+    return out.str();
+}
+
+static bool readFarmEntry(GameState& game, FarmEntry& entry) {
+    if (!dungeonSelectionMenu(game, entry.biome, entry.size)) {
+        return false;
+    }
+    
+    clearScreen();
+    printHeader("🌾 ADD TO QUEUE");
+    std::cout << "\n🎯 Farm until:\n";
+    std::cout << "  1. A number of runs\n";
+    std::cout << "  2. Reaching a level\n";
+    std::cout << "  3. Holding an amount of gold\n";
+    
+    std::string choice;
+    std::cout << "\nChoose a goal: ";
+    std::getline(std::cin, choice);
+    if (choice == "1") {
+        entry.goal = FarmGoal::RUNS;
+    } else if (choice == "2") {
+        entry.goal = FarmGoal::LEVEL;
+    } else if (choice == "3") {
+        entry.goal = FarmGoal::GOLD;
+    } else {
+        return false;
+    }
+    
+    std::cout << "Target: ";
+    std::getline(std::cin, choice);
+    try {
+        entry.target = std::stoi(choice);
+    } catch (...) {
+        return false;
+    }
+    if (entry.target <= 0) {
+        return false;
+    }
+    
+    std::cout << "\n⬆️  Between runs, spend gold on:\n";
+    std::cout << "  0. Nothing\n";
+    std::cout << "  1. Health\n";
+    std::cout << "  2. Attack\n";
+    std::cout << "  3. Defense\n";
+    std::cout << "  4. Whichever upgrade is cheapest\n";
+    std::cout << "\nChoose a rule: ";
+    std::getline(std::cin, choice);
+    if (choice.size() != 1 || choice < "0" || choice > "4") {
+        return false;
+    }
+    entry.upgrade = static_cast<UpgradeRule>(choice[0] - '0');
+    
+    std::cout << "Equip best gear before each run? (y/n): ";
+    std::getline(std::cin, choice);
+    entry.equipBest = (choice == "y" || choice == "Y");
+    return true;
+}
+
+// Shows progress until the queue finishes or the player stops it, then
+// takes over the farmed state
+static void farmingProgressScreen(GameState& game, FarmingScheduler& farming) {
+    const auto& queue = farming.queue();
+    while (true) {
+        FarmingReport report = farming.report();
+        clearScreen();
+        printHeader(report.running ? "🌾 FARMING..." : "🌾 FARMING DONE");
+        
+        std::cout << "\n📋 Queue:\n";
+        for (size_t i = 0; i < queue.size(); i++) {
+            const char* marker = i < report.entryIndex ? "✅" : (i == report.entryIndex ? "▶️ " : "  ");
+            std::cout << "  " << marker << " " << FarmingScheduler::describeEntry(game, queue[i]);
+            if (i == report.entryIndex) {
+                std::cout << " (" << report.entryRuns << " done)";
+            }
+            std::cout << "\n";
+        }
+        
+        std::cout << "\n📊 Runs: " << report.runs << " (" << report.clears << " cleared, "
+                  << report.deaths << " died)\n";
+        std::cout << "💰 Gold earned: " << report.goldEarned << "\n";
+        std::cout << "⭐ Levels gained: " << report.levelsGained << "\n";
+        std::cout << "⬆️  Upgrades bought: " << report.upgradesBought << "\n";
+        std::cout << "⏱️  Time: " << formatDuration(report.simSeconds) << " in game, "
+                  << formatDuration(report.wallSeconds) << " real\n";
+        std::cout << "🏃 Runs/hour: " << std::fixed << std::setprecision(1)
+                  << report.runsPerSimHour() << " in game, " << report.runsPerWallHour()
+                  << " real\n" << std::defaultfloat;
+        
+        if (!report.running) {
+            break;
+        }
+        std::cout << "\nPress Enter to refresh, or S to stop: ";
+        std::string input;
+        if (!std::getline(std::cin, input) || input == "s" || input == "S") {
+            break;
+        }
+    }
+    
+    FarmingReport report = farming.finish(game);
+    std::cout << "\n🌾 Farmed " << report.runs << " run(s). Progress kept.\n";
+    std::cout << "\nPress Enter to continue...";
+    std::cin.get();
+}
+
+void farmingMenu(GameState& game, FarmingScheduler& farming) {
+    static const double speeds[] = {1.0, 10.0, 100.0, 0.0};
+    auto& queue = farming.queue();
+    
+    while (true) {
+        clearScreen();
+        printHeader("🌾 FARMING QUEUE");
+        printPlayerStats(game.getPlayer());
+        
+        std::cout << "\n📋 Queue:\n";
+        if (queue.empty()) {
+            std::cout << "  (empty)\n";
+        }
+        for (size_t i = 0; i < queue.size(); i++) {
+            std::cout << "  " << (i + 1) << ". " << FarmingScheduler::describeEntry(game, queue[i]) << "\n";
+        }
+        
+        std::cout << "\n🌾 Options:\n";
+        std::cout << "  1. Add dungeon\n";
+        std::cout << "  2. Remove last\n";
+        std::cout << "  3. Clear queue\n";
+        std::cout << "  4. Start farming\n";
+        std::cout << "\n  0. Back to Main Menu\n";
+        
+        std::string choice;
+        std::cout << "\nChoose an option: ";
+        if (!std::getline(std::cin, choice) || choice == "0") {
+            return;
+        }
+        
+        if (choice == "1") {
+            FarmEntry entry = {};
+            if (readFarmEntry(game, entry)) {
+                queue.push_back(entry);
+            }
+        } else if (choice == "2" && !queue.empty()) {
+            queue.pop_back();
+        } else if (choice == "3") {
+            queue.clear();
+        } else if (choice == "4" && !queue.empty()) {
+            std::cout << "\n⏩ Speed:\n";
+            std::cout << "  1. Real time\n";
+            std::cout << "  2. 10x\n";
+            std::cout << "  3. 100x\n";
+            std::cout << "  4. As fast as possible\n";
+            std::cout << "\nChoose a speed: ";
+            std::getline(std::cin, choice);
+            if (choice.size() == 1 && choice >= "1" && choice <= "4" &&
+                farming.start(game, speeds[choice[0] - '1'])) {
+                farmingProgressScreen(game, farming);
+            }
+        }
+    }
+}
@@ -5,10 +5,28 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <iosfwd>
+#include <random>
+#include "cow_ptr.h"
+#include "combat_log.h"
+#include "achievements.h"
+#include "loot.h"
+#include "balance.h"
+#include "status_effects.h"
+
+// For small helpers on the combat path that the compiler would otherwise
+// call out of line
+#if defined(_MSC_VER)
+#define ALWAYS_INLINE __forceinline
+#else
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
 
 // Forward declarations
 class Enemy;
 class Player;
+class SaveSlotManager;
+class FarmingScheduler;
 
 // Enums
 enum class Biome {
@@ -33,6 +51,29 @@ struct DungeonSizeInfo {
     double difficultyMultiplier;
 };
 
+// Enemy stats for every floor of a dungeon size, precomputed from the
+// balance formulas so spawning an enemy is a table lookup
+struct FloorScaling {
+    std::vector<EnemyScaling> floors;   // Index is floor - 1
+    EnemyScaling boss;
+};
+
+// Elemental identity of a biome's enemies
+struct BiomeAffinity {
+    Element element;                                // Element of their attacks
+    std::uint8_t inflicts;                          // StatusEffect bits their hits apply
+    std::array<int, ELEMENT_COUNT> resistPercent;   // Negative is a weakness
+};
+
+// Static content shared by every GameState copy
+struct GameData {
+    std::map<Biome, std::vector<std::string>> enemyTypes;
+    std::map<DungeonSize, DungeonSizeInfo> dungeonSizeInfo;
+    std::map<Biome, std::string> biomeNames;
+    std::map<DungeonSize, FloorScaling> enemyScaling;
+    std::map<Biome, BiomeAffinity> affinities;
+};
+
 // Enemy class
 class Enemy {
 public:
@@ -44,9 +85,17 @@ public:
     int goldReward;
     int expReward;
     
+    // Elements (from the biome) and active effects
+    Element element;
+    std::uint8_t inflicts;
+    std::array<int, ELEMENT_COUNT> resistPercent;
+    StatusEffects status;
+    
     Enemy(const std::string& n, int h, int atk, int def, int gold, int exp);
     bool isAlive() const;
     int takeDamage(int damage);
+    // Ignores defense and resistances
+    int loseHealth(int amount);
 };
 
 // Player class
@@ -64,15 +113,30 @@ public:
     int floorsCleared;
     int dungeonsCompleted;
     
+    // Equipment bonuses, folded into cached totals so combat never sums them
+    EquipmentBonus gear;
+    int effectiveAttack;
+    int effectiveDefense;
+    int effectiveMaxHealth;
+    std::array<int, ELEMENT_COUNT> resistPercent;   // Capped at MAX_RESIST_PERCENT
+    
+    // Cleared whenever the player returns to town
+    StatusEffects status;
+    
     Player();
     bool isAlive() const;
-    int takeDamage(int damage);
+    // Reduced by defense, then by resistance to the element
+    int takeDamage(int damage, Element element = Element::PHYSICAL);
+    int loseHealth(int amount);
     void heal(int amount);
     void fullHeal();
     void gainExperience(int exp);
     void levelUp();
     bool canAfford(int cost) const;
     bool spendGold(int amount);
+    void applyEquipment(const EquipmentBonus& bonus);
+    void recalculateStats();
+    BalanceInputs balanceInputs() const;
 };
 
 // Combat result structure
@@ -85,22 +149,59 @@ struct CombatResult {
     bool dungeonCompleted;
 };
 
+// Projected outcome of simulated dungeon runs
+struct RunProjection {
+    int trials;
+    double clearRate;
+    double avgFloorsCleared;
+    double avgGold;
+};
+
 // Game state class
+//
+// Copying a GameState is O(1) and allocation-free: static content is shared
+// through GameData and the current enemy is copy-on-write, so a copy can be
+// used as a snapshot for rewinding or as a fork for what-if simulation.
 class GameState {
 private:
     Player player;
     Biome currentBiome;
     DungeonSize currentDungeonSize;
     int currentFloor;
-    std::shared_ptr<Enemy> currentEnemy;
+    CowPtr<Enemy> currentEnemy;
     bool autoBattle;
     bool inDungeon;
     
-    std::map<Biome, std::vector<std::string>> enemyTypes;
-    std::map<DungeonSize, DungeonSizeInfo> dungeonSizeInfo;
-    std::map<Biome, std::string> biomeNames;
+    AchievementTracker achievements;
+    int damageTakenThisRun;
+    CowPtr<Inventory> inventory;
+    bool simulated;
+    // The player's elemental gear damage per hit on the current enemy, after
+    // its resistances, and the potency of the effects it inflicts there;
+    // resolved on spawn and equip rather than every hit
+    int elementalHit;
+    std::array<std::uint16_t, STATUS_EFFECT_COUNT> elementalPotency;
     
-    void initializeData();
+    std::shared_ptr<const GameData> data;
+    CombatLog* combatLog;
+    std::mt19937* rng;          // Enemy and loot rolls; never null
+    
+    static std::shared_ptr<const GameData> initializeData();
+    // Defined here and forced inline so combat without a log, as in
+    // simulations, pays only the check, and a logged exchange no call
+    ALWAYS_INLINE void logEvent(CombatEventKind kind, std::uint8_t detail = 0, int a = 0, int b = 0) {
+        if (combatLog) {
+            combatLog->record(kind, detail, currentFloor, a, b);
+        }
+    }
+    void addToCounter(AchievementCounter counter, std::int64_t delta);
+    void raiseCounter(AchievementCounter counter, std::int64_t value);
+    void rollLoot(bool boss);
+    void resolveElementalHit();
+    void exchangeWithEffects(Enemy& enemy, CombatResult& result);
+    void logEffectsStarted(std::uint8_t target, const StatusEffects& status, std::uint8_t effects);
+    void defeatEnemy(CombatResult& result);
+    void defeatPlayer(CombatResult& result);
     
 public:
     bool gameRunning;
@@ -113,9 +214,21 @@ public:
     Biome getCurrentBiome() const;
     DungeonSize getCurrentDungeonSize() const;
     int getCurrentFloor() const;
-    std::shared_ptr<Enemy> getCurrentEnemy() const;
+    std::shared_ptr<const Enemy> getCurrentEnemy() const;
     bool isAutoBattle() const;
     bool isInDungeon() const;
+    const AchievementTracker& getAchievements() const;
+    const Inventory& getInventory() const;
+    
+    // Combat log (not owned; copies share it, simulations detach it)
+    void setCombatLog(CombatLog* log);
+    CombatLog* getCombatLog() const;
+    // nullptr selects the shared engine, which is unsynchronized, so a copy
+    // played on another thread needs an engine of its own
+    void setRandomEngine(std::mt19937* engine);
+    // Deep-copies the storage still shared with other copies (O(inventory)),
+    // so this copy can be played on another thread
+    void detach();
     
     // Game actions
     void startDungeon(Biome biome, DungeonSize size);
@@ -123,20 +236,54 @@ public:
     CombatResult attackEnemy();
     bool upgradeStat(const std::string& stat);
     int getUpgradeCost(const std::string& stat) const;
+    int getUpgradeAmount(const std::string& stat) const;
     void toggleAutoBattle();
     void fleeDungeon();
     
+    // Equipment
+    Inventory& editInventory();
+    int equipBest(GearRank rank);
+    int salvageWorseItems(GearRank rank);
+    
+    // Simulation
+    // A copy for what-if play: it records nothing in the combat log and
+    // rolls no loot
+    GameState fork() const;
+    RunProjection projectRun(Biome biome, DungeonSize size, int trials) const;
+    
     // Save/Load
     bool saveGame(const std::string& filename = "save_game.json");
     bool loadGame(const std::string& filename = "save_game.json");
+    void writeSave(std::ostream& out) const;
+    bool readSave(std::istream& in);
     
     // Utility
     std::string getBiomeName(Biome biome) const;
+    std::string getEnemyTypeName(Biome biome, int index) const;
+    const BiomeAffinity& getBiomeAffinity(Biome biome) const;
     DungeonSizeInfo getDungeonSizeInfo(DungeonSize size) const;
     std::vector<Biome> getAllBiomes() const;
     std::vector<DungeonSize> getAllDungeonSizes() const;
 };
 
+// Fixed-size ring of GameState snapshots for rewinding recent actions.
+// Rewinding also drops the rewound actions' events from the combat log.
+class StateHistory {
+private:
+    std::vector<GameState> ring;
+    std::vector<std::uint64_t> logMarks;    // Log position when each snapshot was taken
+    size_t head;
+    size_t count;
+    
+public:
+    explicit StateHistory(size_t capacity);
+    
+    void record(const GameState& state);
+    bool rewind(GameState& state, size_t steps = 1);
+    size_t size() const;
+    void clear();
+};
+
 // UI functions
 void clearScreen();
 void printHeader(const std::string& text);
@@ -149,5 +296,10 @@ bool dungeonSelectionMenu(GameState& game, Biome& outBiome, DungeonSize& outSize
 void combatMenu(GameState& game);
 void upgradeMenu(GameState& game);
 void statisticsMenu(const GameState& game);
+void combatLogMenu(const GameState& game);
+void inventoryMenu(GameState& game);
+void saveSlotMenu(const GameState& game, SaveSlotManager& slots);
+bool loadSlotMenu(GameState& game, const SaveSlotManager& slots);
+void farmingMenu(GameState& game, FarmingScheduler& farming);
 
 #endif // GAME_H
@@ -0,0 +1,673 @@
+#include "loot.h"
+#include <algorithm>
+#include <iterator>
+
+// Item implementation
+int Item::total(AffixStat stat) const {
+    int sum = 0;
+    for (std::uint8_t i = 0; i < affixCount; i++) {
+        if (affixStat(affixes[i]) == stat) {
+            sum += affixValue(affixes[i]);
+        }
+    }
+    return sum;
+}
+
+int Item::rankScore(GearRank rank) const {
+    return rankScores()[static_cast<std::size_t>(rank)];
+}
+
+std::array<int, GEAR_RANK_COUNT> Item::rankScores() const {
+    std::array<int, static_cast<std::size_t>(AffixStat::COUNT)> totals = {};
+    for (std::uint8_t i = 0; i < affixCount; i++) {
+        totals[static_cast<std::size_t>(affixStat(affixes[i]))] += affixValue(affixes[i]);
+    }
+    auto totalOf = [&](AffixStat stat) { return totals[static_cast<std::size_t>(stat)]; };
+
+    // Roughly what each point is worth compared to a max health point.
+    // Elemental damage skips defense and inflicts effects, so it weighs like attack
+    int power = totalOf(AffixStat::ATTACK) * 4 + totalOf(AffixStat::DEFENSE) * 5 +
+                totalOf(AffixStat::MAX_HEALTH) + totalOf(AffixStat::GOLD_FIND) * 2 +
+                totalOf(AffixStat::EXP_BONUS) * 2;
+    for (std::size_t e = 1; e < ELEMENT_COUNT; e++) {
+        power += totalOf(elementDamageAffix(static_cast<Element>(e))) * 4 +
+                 totalOf(elementResistAffix(static_cast<Element>(e))) * 2;
+    }
+    return {totalOf(AffixStat::ATTACK), totalOf(AffixStat::DEFENSE), totalOf(AffixStat::MAX_HEALTH), power};
+}
+
+int Item::salvageValue() const {
+    return itemLevel * (static_cast<int>(rarity) + 1) * 2 + 1;
+}
+
+// Stable counting sort by score. Entries already in ascending id order come
+// out in (score, id) order; used when rebuilding every ranking at once, where
+// it beats std::sort. Returns false, leaving entries untouched, when the
+// scores span too wide a range to count.
+static bool countingSortByScore(std::vector<RankIndex::Entry>& entries) {
+    const long maxRange = 1 << 16;
+    if (entries.empty()) {
+        return true;
+    }
+    auto bounds = std::minmax_element(entries.begin(), entries.end());
+    int low = bounds.first->first;
+    long range = static_cast<long>(bounds.second->first) - low + 1;
+    if (range > maxRange) {
+        return false;
+    }
+
+    std::vector<std::size_t> offsets(static_cast<std::size_t>(range) + 1);
+    for (const auto& entry : entries) {
+        offsets[static_cast<std::size_t>(entry.first - low) + 1]++;
+    }
+    for (std::size_t i = 1; i < offsets.size(); i++) {
+        offsets[i] += offsets[i - 1];
+    }
+    std::vector<RankIndex::Entry> ordered(entries.size());
+    for (const auto& entry : entries) {
+        ordered[offsets[static_cast<std::size_t>(entry.first - low)]++] = entry;
+    }
+    entries.swap(ordered);
+    return true;
+}
+
+// RankIndex implementation
+RankIndex::RankIndex() : sorted(std::make_shared<std::vector<Entry>>()) {}
+
+void RankIndex::insert(const Entry& entry) {
+    tail.push_back(entry);
+    if (tail.size() >= MAX_TAIL) {
+        flush();
+    }
+}
+
+void RankIndex::assign(std::vector<Entry> entries) {
+    sorted = CowPtr<std::vector<Entry>>(std::make_shared<std::vector<Entry>>(std::move(entries)));
+    tail.clear();
+}
+
+void RankIndex::erase(const Entry& entry) {
+    auto it = std::lower_bound(sorted->begin(), sorted->end(), entry);
+    if (it != sorted->end() && *it == entry) {
+        std::ptrdiff_t position = it - sorted->begin();
+        std::vector<Entry>& entries = sorted.write();
+        entries.erase(entries.begin() + position);
+        return;
+    }
+    auto inTail = std::find(tail.begin(), tail.end(), entry);
+    if (inTail != tail.end()) {
+        *inTail = tail.back();
+        tail.pop_back();
+    }
+}
+
+void RankIndex::clear() {
+    sorted = CowPtr<std::vector<Entry>>(std::make_shared<std::vector<Entry>>());
+    tail.clear();
+}
+
+void RankIndex::detach() {
+    sorted.detach();
+}
+
+std::size_t RankIndex::size() const {
+    return sorted->size() + tail.size();
+}
+
+RankIndex::Entry RankIndex::best() const {
+    Entry top = sorted->empty() ? tail.front() : sorted->back();
+    for (const Entry& entry : tail) {
+        top = std::max(top, entry);
+    }
+    return top;
+}
+
+void RankIndex::flush() {
+    if (tail.empty()) {
+        return;
+    }
+    std::sort(tail.begin(), tail.end());
+    mergeTail();
+}
+
+// Merges the sorted tail into the sorted part and empties it
+void RankIndex::mergeTail() {
+    if (!sorted.isShared()) {
+        std::vector<Entry>& entries = sorted.write();
+        std::size_t middle = entries.size();
+        entries.insert(entries.end(), tail.begin(), tail.end());
+        std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end());
+    } else {
+        // Merged into a fresh vector, so the copy sharing the old one keeps it
+        auto merged = std::make_shared<std::vector<Entry>>();
+        merged->reserve(sorted->size() + tail.size());
+        std::merge(sorted->begin(), sorted->end(), tail.begin(), tail.end(), std::back_inserter(*merged));
+        sorted = CowPtr<std::vector<Entry>>(std::move(merged));
+    }
+    tail.clear();
+}
+
+void RankIndex::eraseBelow(int score, std::vector<std::uint32_t>& ids) {
+    flush();
+    // Ids are unsigned, so (score, 0) is the first entry not below score
+    auto end = std::lower_bound(sorted->begin(), sorted->end(), Entry(score, 0));
+    if (end == sorted->begin()) {
+        return;
+    }
+    std::ptrdiff_t count = end - sorted->begin();
+    for (auto it = sorted->begin(); it != end; ++it) {
+        ids.push_back(it->second);
+    }
+    std::vector<Entry>& entries = sorted.write();
+    entries.erase(entries.begin(), entries.begin() + count);
+}
+
+// Inventory implementation
+Inventory::Inventory() : poolSize(0), freeHead(NO_FREE), ranked(true), bonus(), liveCount(0) {
+    slotCounts.fill(0);
+    equippedIds.fill(NO_ITEM);
+}
+
+std::uint32_t Inventory::add(const Item& item) {
+    if (isFull()) {
+        return NO_ITEM;
+    }
+
+    ensureRanked();
+    std::uint32_t id = allocate(item);
+    index(id);
+    return id;
+}
+
+std::vector<std::uint32_t> Inventory::addAll(const std::vector<Item>& items) {
+    std::vector<std::uint32_t> ids;
+    ids.reserve(items.size());
+    for (const Item& item : items) {
+        if (isFull()) {
+            break;
+        }
+        ids.push_back(allocate(item));
+    }
+    if (!ids.empty()) {
+        ranked = false;
+    }
+    return ids;
+}
+
+int Inventory::salvage(std::uint32_t id) {
+    if (!isAlive(id) || isEquipped(id)) {
+        return 0;
+    }
+
+    ensureRanked();
+    int value = get(id).salvageValue();
+    unindex(id);
+    release(id);
+    return value;
+}
+
+void Inventory::detach() {
+    for (auto& chunk : chunks) {
+        chunk.detach();
+    }
+    for (auto& slotRankings : rankings) {
+        for (auto& ranking : slotRankings) {
+            ranking.detach();
+        }
+    }
+}
+
+void Inventory::clear() {
+    chunks.clear();
+    poolSize = 0;
+    freeHead = NO_FREE;
+    for (auto& slotRankings : rankings) {
+        for (auto& ranking : slotRankings) {
+            ranking.clear();
+        }
+    }
+    ranked = true;
+    slotCounts.fill(0);
+    equippedIds.fill(NO_ITEM);
+    liveCount = 0;
+    recalculateBonuses();
+}
+
+bool Inventory::isAlive(std::uint32_t id) const {
+    return id < poolSize && get(id).alive;
+}
+
+const Item& Inventory::get(std::uint32_t id) const {
+    return (*chunks[id / CHUNK_ITEMS])[id % CHUNK_ITEMS];
+}
+
+std::size_t Inventory::size() const {
+    return liveCount;
+}
+
+bool Inventory::isFull() const {
+    return liveCount >= MAX_ITEMS;
+}
+
+std::size_t Inventory::countInSlot(EquipSlot slot) const {
+    return slotCounts[static_cast<std::size_t>(slot)];
+}
+
+std::uint32_t Inventory::equipped(EquipSlot slot) const {
+    return equippedIds[static_cast<std::size_t>(slot)];
+}
+
+bool Inventory::isEquipped(std::uint32_t id) const {
+    return isAlive(id) && equippedIds[static_cast<std::size_t>(get(id).slot)] == id;
+}
+
+bool Inventory::equip(std::uint32_t id) {
+    if (!isAlive(id)) {
+        return false;
+    }
+    equippedIds[static_cast<std::size_t>(get(id).slot)] = id;
+    recalculateBonuses();
+    return true;
+}
+
+std::uint32_t Inventory::bestFor(EquipSlot slot, GearRank rank) const {
+    if (!ranked) {
+        // Stale rankings can't be rebuilt from a const call, so scan instead
+        RankIndex::Entry top(0, NO_ITEM);
+        for (std::uint32_t id = 0; id < poolSize; id++) {
+            const Item& item = get(id);
+            if (!item.alive || item.slot != slot) {
+                continue;
+            }
+            RankIndex::Entry entry(item.rankScore(rank), id);
+            if (top.second == NO_ITEM || entry > top) {
+                top = entry;
+            }
+        }
+        return top.second;
+    }
+    const RankIndex& ranking = rankings[static_cast<std::size_t>(slot)][static_cast<std::size_t>(rank)];
+    return ranking.size() == 0 ? NO_ITEM : ranking.best().second;
+}
+
+int Inventory::equipBest(GearRank rank) {
+    ensureRanked();
+    int changed = 0;
+    for (std::size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+        rankings[s][static_cast<std::size_t>(rank)].flush();
+        std::uint32_t best = bestFor(static_cast<EquipSlot>(s), rank);
+        std::uint32_t current = equippedIds[s];
+        if (best == NO_ITEM || best == current) {
+            continue;
+        }
+        if (current == NO_ITEM || get(best).rankScore(rank) > get(current).rankScore(rank)) {
+            equippedIds[s] = best;
+            changed++;
+        }
+    }
+    if (changed > 0) {
+        recalculateBonuses();
+    }
+    return changed;
+}
+
+int Inventory::salvageWorse(GearRank rank, int& gold) {
+    ensureRanked();
+    int removed = 0;
+    std::vector<std::uint32_t> worse;
+    for (std::size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+        std::uint32_t current = equippedIds[s];
+        if (current == NO_ITEM) {
+            continue;
+        }
+
+        // The ranking is ordered, so everything worse is a prefix of it; the
+        // other rankings drop the same items in one pass each
+        worse.clear();
+        rankings[s][static_cast<std::size_t>(rank)].eraseBelow(get(current).rankScore(rank), worse);
+        if (worse.empty()) {
+            continue;
+        }
+        for (std::uint32_t id : worse) {
+            gold += get(id).salvageValue();
+            release(id);
+        }
+        removed += static_cast<int>(worse.size());
+        for (std::size_t r = 0; r < GEAR_RANK_COUNT; r++) {
+            if (r != static_cast<std::size_t>(rank)) {
+                rankings[s][r].eraseIf([this](const RankIndex::Entry& entry) {
+                    return !get(entry.second).alive;
+                });
+            }
+        }
+    }
+    return removed;
+}
+
+const EquipmentBonus& Inventory::bonuses() const {
+    return bonus;
+}
+
+std::vector<std::uint32_t> Inventory::liveIds() const {
+    std::vector<std::uint32_t> ids;
+    ids.reserve(liveCount);
+    for (std::uint32_t id = 0; id < poolSize; id++) {
+        if (get(id).alive) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+// Stores a live item in a free or new id without indexing it
+std::uint32_t Inventory::allocate(const Item& item) {
+    std::uint32_t id;
+    if (freeHead != NO_FREE) {
+        id = freeHead;
+        freeHead = get(id).nextFree;
+    } else {
+        id = poolSize++;
+        if (id % CHUNK_ITEMS == 0) {
+            chunks.push_back(CowPtr<ItemChunk>(std::make_shared<ItemChunk>()));
+        }
+    }
+    Item& slot = edit(id);
+    slot = item;
+    slot.alive = 1;
+    slotCounts[static_cast<std::size_t>(item.slot)]++;
+    liveCount++;
+    return id;
+}
+
+// Mutable access; clones the item's chunk if a copy still shares it
+Item& Inventory::edit(std::uint32_t id) {
+    return chunks[id / CHUNK_ITEMS].write()[id % CHUNK_ITEMS];
+}
+
+// Marks an unindexed item dead and pushes it onto the free list
+void Inventory::release(std::uint32_t id) {
+    Item& item = edit(id);
+    item.alive = 0;
+    item.nextFree = freeHead;
+    freeHead = static_cast<std::uint16_t>(id);
+    slotCounts[static_cast<std::size_t>(item.slot)]--;
+    liveCount--;
+}
+
+// Rebuilds every ranking from the pool after a bulk add. Ids are visited in
+// ascending order, so a stable sort by score leaves each in (score, id) order.
+void Inventory::ensureRanked() {
+    if (ranked) {
+        return;
+    }
+    std::array<std::array<std::vector<RankIndex::Entry>, GEAR_RANK_COUNT>, EQUIP_SLOT_COUNT> entries;
+    for (std::size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+        for (auto& rankEntries : entries[s]) {
+            rankEntries.reserve(slotCounts[s]);
+        }
+    }
+    for (std::uint32_t id = 0; id < poolSize; id++) {
+        const Item& item = get(id);
+        if (!item.alive) {
+            continue;
+        }
+        auto& slotEntries = entries[static_cast<std::size_t>(item.slot)];
+        std::array<int, GEAR_RANK_COUNT> scores = item.rankScores();
+        for (std::size_t r = 0; r < GEAR_RANK_COUNT; r++) {
+            slotEntries[r].push_back(RankIndex::Entry(scores[r], id));
+        }
+    }
+    for (std::size_t s = 0; s < EQUIP_SLOT_COUNT; s++) {
+        for (std::size_t r = 0; r < GEAR_RANK_COUNT; r++) {
+            if (!countingSortByScore(entries[s][r])) {
+                std::sort(entries[s][r].begin(), entries[s][r].end());
+            }
+            rankings[s][r].assign(std::move(entries[s][r]));
+        }
+    }
+    ranked = true;
+}
+
+void Inventory::index(std::uint32_t id) {
+    const Item& item = get(id);
+    auto& slotRankings = rankings[static_cast<std::size_t>(item.slot)];
+    std::array<int, GEAR_RANK_COUNT> scores = item.rankScores();
+    for (std::size_t r = 0; r < GEAR_RANK_COUNT; r++) {
+        slotRankings[r].insert(RankIndex::Entry(scores[r], id));
+    }
+}
+
+void Inventory::unindex(std::uint32_t id) {
+    const Item& item = get(id);
+    auto& slotRankings = rankings[static_cast<std::size_t>(item.slot)];
+    std::array<int, GEAR_RANK_COUNT> scores = item.rankScores();
+    for (std::size_t r = 0; r < GEAR_RANK_COUNT; r++) {
+        slotRankings[r].erase(RankIndex::Entry(scores[r], id));
+    }
+}
+
+void Inventory::recalculateBonuses() {
+    bonus = EquipmentBonus();
+    for (std::uint32_t id : equippedIds) {
+        if (id == NO_ITEM) {
+            continue;
+        }
+        const Item& item = get(id);
+        bonus.attack += item.total(AffixStat::ATTACK);
+        bonus.defense += item.total(AffixStat::DEFENSE);
+        bonus.maxHealth += item.total(AffixStat::MAX_HEALTH);
+        bonus.goldFindPercent += item.total(AffixStat::GOLD_FIND);
+        bonus.expBonusPercent += item.total(AffixStat::EXP_BONUS);
+        for (std::size_t e = 1; e < ELEMENT_COUNT; e++) {
+            bonus.elementDamage[e] += item.total(elementDamageAffix(static_cast<Element>(e)));
+            bonus.resistPercent[e] += item.total(elementResistAffix(static_cast<Element>(e)));
+        }
+    }
+    for (std::size_t e = 1; e < ELEMENT_COUNT; e++) {
+        if (bonus.elementDamage[e] > 0) {
+            bonus.elementMask |= elementBit(static_cast<Element>(e));
+        }
+    }
+}
+
+// Loot generation
+static int affixBase(AffixStat stat, int itemLevel) {
+    switch (stat) {
+        case AffixStat::ATTACK:
+            return 2 + itemLevel / 2;
+        case AffixStat::DEFENSE:
+            return 1 + itemLevel / 3;
+        case AffixStat::MAX_HEALTH:
+            return 10 + itemLevel * 2;
+        case AffixStat::FIRE_DAMAGE:
+        case AffixStat::FROST_DAMAGE:
+        case AffixStat::POISON_DAMAGE:
+        case AffixStat::LIGHTNING_DAMAGE:
+            return 1 + itemLevel / 3;
+        default:
+            return 3 + itemLevel / 5;
+    }
+}
+
+Item generateItem(int itemLevel, bool boss, std::mt19937& rng) {
+    std::uniform_int_distribution<> percent(0, 99);
+    std::uniform_int_distribution<> slotDis(0, static_cast<int>(EQUIP_SLOT_COUNT) - 1);
+    std::uniform_int_distribution<> statDis(0, static_cast<int>(AffixStat::COUNT) - 1);
+    std::uniform_int_distribution<> rollDis(50, 100);
+
+    Item item = {};
+    item.slot = static_cast<EquipSlot>(slotDis(rng));
+    item.itemLevel = static_cast<std::uint16_t>(std::max(1, std::min(itemLevel, 0xFFFF)));
+
+    // Bosses roll on a better rarity table
+    int roll = percent(rng);
+    if (roll < (boss ? 10 : 1)) {
+        item.rarity = Rarity::LEGENDARY;
+    } else if (roll < (boss ? 40 : 8)) {
+        item.rarity = Rarity::RARE;
+    } else if (roll < (boss ? 80 : 30)) {
+        item.rarity = Rarity::MAGIC;
+    } else {
+        item.rarity = Rarity::COMMON;
+    }
+    item.affixCount = static_cast<std::uint8_t>(static_cast<int>(item.rarity) + 1);
+
+    // The first affix matches the slot; the rest are random
+    for (std::uint8_t i = 0; i < item.affixCount; i++) {
+        AffixStat stat;
+        if (i == 0 && item.slot == EquipSlot::WEAPON) {
+            stat = AffixStat::ATTACK;
+        } else if (i == 0 && item.slot == EquipSlot::ARMOR) {
+            stat = AffixStat::DEFENSE;
+        } else if (i == 0 && item.slot == EquipSlot::HELMET) {
+            stat = AffixStat::MAX_HEALTH;
+        } else {
+            stat = static_cast<AffixStat>(statDis(rng));
+        }
+        double rarityMultiplier = 1.0 + static_cast<int>(item.rarity) * 0.25;
+        int value = static_cast<int>(affixBase(stat, item.itemLevel) * rollDis(rng) / 100.0 * rarityMultiplier);
+        item.affixes[i] = packAffix(stat, std::max(1, value));
+    }
+    return item;
+}
+
+std::string getSlotName(EquipSlot slot) {
+    switch (slot) {
+        case EquipSlot::WEAPON: return "Weapon";
+        case EquipSlot::ARMOR: return "Armor";
+        case EquipSlot::HELMET: return "Helmet";
+        case EquipSlot::RING: return "Ring";
+        default: return "Unknown";
+    }
+}
+
+std::string getRarityName(Rarity rarity) {
+    switch (rarity) {
+        case Rarity::COMMON: return "Common";
+        case Rarity::MAGIC: return "Magic";
+        case Rarity::RARE: return "Rare";
+        case Rarity::LEGENDARY: return "Legendary";
+        default: return "Unknown";
+    }
+}
+
+std::string describeItem(const Item& item) {
+    static const char* const affixLabels[] = {" ATK", " DEF", " HP", "% gold", "% exp",
+                                              " fire dmg", " frost dmg", " poison dmg", " lightning dmg",
+                                              "% fire res", "% frost res", "% poison res", "% lightning res"};
+
+    std::string text = getRarityName(item.rarity) + " " + getSlotName(item.slot) +
+                       " [iLvl " + std::to_string(item.itemLevel) + "]:";
+    for (std::uint8_t i = 0; i < item.affixCount; i++) {
+        text += (i > 0 ? ", +" : " +") + std::to_string(affixValue(item.affixes[i])) +
+                affixLabels[static_cast<int>(affixStat(item.affixes[i]))];
+    }
+    return text;
+}
+
+// Save encoding
+static_assert(EQUIP_SLOT_COUNT <= 4 && MAX_AFFIXES <= 15, "Item header fields must fit their bits");
+
+static const char BASE64_DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string encodeItems(const std::vector<Item>& items) {
+    std::string bytes;
+    bytes.reserve(items.size() * (3 + 2 * MAX_AFFIXES));
+    for (const Item& item : items) {
+        bytes += static_cast<char>(static_cast<unsigned>(item.slot) |
+                                   static_cast<unsigned>(item.rarity) << 2 |
+                                   static_cast<unsigned>(item.affixCount) << 4);
+        bytes += static_cast<char>(item.itemLevel & 0xFF);
+        bytes += static_cast<char>(item.itemLevel >> 8);
+        for (std::uint8_t a = 0; a < item.affixCount; a++) {
+            bytes += static_cast<char>(item.affixes[a] & 0xFF);
+            bytes += static_cast<char>(item.affixes[a] >> 8);
+        }
+    }
+
+    // Unpadded: a trailing group of 1 or 2 bytes becomes 2 or 3 digits
+    std::string text;
+    text.reserve((bytes.size() + 2) / 3 * 4);
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+        std::size_t count = std::min<std::size_t>(3, bytes.size() - i);
+        std::uint32_t group = 0;
+        for (std::size_t b = 0; b < 3; b++) {
+            group = group << 8 | (b < count ? static_cast<unsigned char>(bytes[i + b]) : 0u);
+        }
+        for (std::size_t d = 0; d <= count; d++) {
+            text += BASE64_DIGITS[(group >> (18 - 6 * d)) & 0x3F];
+        }
+    }
+    return text;
+}
+
+bool decodeItems(const std::string& text, std::vector<Item>& items) {
+    // Digit values by character, -1 for anything outside the alphabet
+    static const std::array<signed char, 256> digitValues = [] {
+        std::array<signed char, 256> values;
+        values.fill(-1);
+        for (int d = 0; d < 64; d++) {
+            values[static_cast<unsigned char>(BASE64_DIGITS[d])] = static_cast<signed char>(d);
+        }
+        return values;
+    }();
+
+    if (text.size() % 4 == 1) {
+        return false;
+    }
+    const unsigned char* digits = reinterpret_cast<const unsigned char*>(text.data());
+    std::vector<unsigned char> bytes(text.size() * 3 / 4);
+    std::size_t written = 0;
+    std::size_t fullGroups = text.size() / 4 * 4;
+    for (std::size_t i = 0; i < fullGroups; i += 4) {
+        int a = digitValues[digits[i]], b = digitValues[digits[i + 1]];
+        int c = digitValues[digits[i + 2]], d = digitValues[digits[i + 3]];
+        if ((a | b | c | d) < 0) {
+            return false;
+        }
+        std::uint32_t group = static_cast<std::uint32_t>(a << 18 | b << 12 | c << 6 | d);
+        bytes[written] = static_cast<unsigned char>(group >> 16);
+        bytes[written + 1] = static_cast<unsigned char>(group >> 8);
+        bytes[written + 2] = static_cast<unsigned char>(group);
+        written += 3;
+    }
+    if (fullGroups < text.size()) {
+        // 2 or 3 trailing digits carry 1 or 2 bytes
+        int a = digitValues[digits[fullGroups]], b = digitValues[digits[fullGroups + 1]];
+        int c = fullGroups + 2 < text.size() ? digitValues[digits[fullGroups + 2]] : 0;
+        if ((a | b | c) < 0) {
+            return false;
+        }
+        std::uint32_t group = static_cast<std::uint32_t>(a << 18 | b << 12 | c << 6);
+        bytes[written++] = static_cast<unsigned char>(group >> 16);
+        if (fullGroups + 2 < text.size()) {
+            bytes[written++] = static_cast<unsigned char>(group >> 8);
+        }
+    }
+
+    std::size_t pos = 0;
+    while (pos < written) {
+        unsigned header = bytes[pos];
+        std::size_t affixCount = header >> 4;
+        if (affixCount < 1 || affixCount > MAX_AFFIXES || pos + 3 + 2 * affixCount > written ||
+            ((header >> 2) & 3) > static_cast<unsigned>(Rarity::LEGENDARY)) {
+            return false;
+        }
+
+        Item item = {};
+        item.slot = static_cast<EquipSlot>(header & 3);
+        item.rarity = static_cast<Rarity>((header >> 2) & 3);
+        item.affixCount = static_cast<std::uint8_t>(affixCount);
+        item.itemLevel = static_cast<std::uint16_t>(std::max(1, bytes[pos + 1] | bytes[pos + 2] << 8));
+        for (std::size_t a = 0; a < affixCount; a++) {
+            std::uint16_t affix = static_cast<std::uint16_t>(bytes[pos + 3 + 2 * a] | bytes[pos + 4 + 2 * a] << 8);
+            if (affixStat(affix) >= AffixStat::COUNT) {
+                return false;
+            }
+            item.affixes[a] = affix;
+        }
+        items.push_back(item);
+        pos += 3 + 2 * affixCount;
+    }
+    return true;
+}
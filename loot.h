@@ -0,0 +1,256 @@
+#ifndef LOOT_H
+#define LOOT_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <utility>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "status_effects.h"
+#include "cow_ptr.h"
+
+enum class EquipSlot : std::uint8_t {
+    WEAPON,
+    ARMOR,
+    HELMET,
+    RING,
+    COUNT
+};
+
+enum class AffixStat : std::uint8_t {
+    ATTACK,
+    DEFENSE,
+    MAX_HEALTH,
+    GOLD_FIND,   // Percent bonus gold from kills
+    EXP_BONUS,   // Percent bonus experience from kills
+    FIRE_DAMAGE, // Elemental damage added to each hit, in Element order
+    FROST_DAMAGE,
+    POISON_DAMAGE,
+    LIGHTNING_DAMAGE,
+    FIRE_RESIST, // Percent resistance, in Element order
+    FROST_RESIST,
+    POISON_RESIST,
+    LIGHTNING_RESIST,
+    COUNT
+};
+
+enum class Rarity : std::uint8_t {
+    COMMON,
+    MAGIC,
+    RARE,
+    LEGENDARY
+};
+
+// What an equip-best or salvage query ranks items by
+enum class GearRank : std::uint8_t {
+    ATTACK,
+    DEFENSE,
+    HEALTH,
+    POWER,       // Weighted sum of all affixes
+    COUNT
+};
+
+const std::size_t EQUIP_SLOT_COUNT = static_cast<std::size_t>(EquipSlot::COUNT);
+const std::size_t GEAR_RANK_COUNT = static_cast<std::size_t>(GearRank::COUNT);
+const std::size_t MAX_AFFIXES = 4;
+
+static_assert(static_cast<unsigned>(AffixStat::COUNT) <= 16, "Affix stats must fit in 4 bits");
+
+inline AffixStat elementDamageAffix(Element element) {
+    return static_cast<AffixStat>(static_cast<int>(AffixStat::FIRE_DAMAGE) + static_cast<int>(element) - 1);
+}
+
+inline AffixStat elementResistAffix(Element element) {
+    return static_cast<AffixStat>(static_cast<int>(AffixStat::FIRE_RESIST) + static_cast<int>(element) - 1);
+}
+
+// Affixes are packed into 16 bits: the stat in the top 4, the value in the low 12
+inline std::uint16_t packAffix(AffixStat stat, int value) {
+    if (value < 0) value = 0;
+    if (value > 0xFFF) value = 0xFFF;
+    return static_cast<std::uint16_t>((static_cast<unsigned>(stat) << 12) | static_cast<unsigned>(value));
+}
+
+inline AffixStat affixStat(std::uint16_t affix) {
+    return static_cast<AffixStat>(affix >> 12);
+}
+
+inline int affixValue(std::uint16_t affix) {
+    return affix & 0xFFF;
+}
+
+// A pooled item: 16 bytes, no heap storage
+struct Item {
+    EquipSlot slot;
+    Rarity rarity;
+    std::uint8_t affixCount;
+    std::uint8_t alive;
+    std::uint16_t itemLevel;
+    std::uint16_t affixes[MAX_AFFIXES];
+    std::uint16_t nextFree;     // Next dead id in the inventory's free list
+
+    int total(AffixStat stat) const;
+    int rankScore(GearRank rank) const;
+    // Every GearRank score from one pass over the affixes
+    std::array<int, GEAR_RANK_COUNT> rankScores() const;
+    int salvageValue() const;
+};
+
+static_assert(sizeof(Item) == 16, "Item must stay compact");
+
+// Sum of equipped affixes, folded into the player's effective stats
+struct EquipmentBonus {
+    int attack;
+    int defense;
+    int maxHealth;
+    int goldFindPercent;
+    int expBonusPercent;
+    std::array<int, ELEMENT_COUNT> elementDamage;   // PHYSICAL unused
+    std::array<int, ELEMENT_COUNT> resistPercent;   // Uncapped; the player caps it
+    std::uint8_t elementMask;                       // Bit per element with damage
+
+    EquipmentBonus() : attack(0), defense(0), maxHealth(0), goldFindPercent(0), expBonusPercent(0),
+                       elementDamage(), resistPercent(), elementMask(0) {}
+};
+
+// One slot's items ordered by one GearRank score, as flat (score, id)
+// entries. Adds go to a short unsorted tail that is merged into the sorted
+// part once full. The sorted part is shared between copies until written, so
+// copying an index only copies the tail.
+class RankIndex {
+public:
+    typedef std::pair<int, std::uint32_t> Entry;
+
+    RankIndex();
+
+    void insert(const Entry& entry);
+    // Replaces every entry with entries already in (score, id) order
+    void assign(std::vector<Entry> entries);
+    void erase(const Entry& entry);
+    void clear();
+    // Stops sharing the sorted part with other copies
+    void detach();
+    std::size_t size() const;
+    // Highest entry; the index must not be empty
+    Entry best() const;
+    // Merges the tail so every entry is in sorted order
+    void flush();
+    // Removes every entry scoring below score, appending their ids to ids
+    void eraseBelow(int score, std::vector<std::uint32_t>& ids);
+
+    // Removes every entry matching dead, keeping the order. The sorted part
+    // is copied out of sharing only when one of its entries is dead.
+    template <typename Dead>
+    void eraseIf(Dead dead) {
+        const auto firstDead = std::find_if(sorted->begin(), sorted->end(), dead);
+        if (firstDead != sorted->end()) {
+            const std::ptrdiff_t from = firstDead - sorted->begin();
+            std::vector<Entry>& entries = sorted.write();
+            entries.erase(std::remove_if(entries.begin() + from, entries.end(), dead), entries.end());
+        }
+        tail.erase(std::remove_if(tail.begin(), tail.end(), dead), tail.end());
+    }
+
+private:
+    static const std::size_t MAX_TAIL = 128;
+
+    CowPtr<std::vector<Entry>> sorted;
+    std::vector<Entry> tail;
+
+    void mergeTail();
+};
+
+// Chunked item pool with per-slot rankings.
+//
+// Items live in fixed-size chunks indexed by id; salvaged ids are recycled
+// through a free list linked through the dead items. Each slot keeps a flat
+// RankIndex per GearRank, so "best item for attack" is a lookup at the end of
+// an index and "everything worse than what is equipped" is a prefix of it,
+// instead of a scan over the whole pool.
+//
+// Chunks and sorted rankings are copy-on-write: copying an Inventory (as every
+// rewind snapshot followed by a drop does) copies pointers and the short
+// ranking tails, and a drop then clones only the chunk it lands in. A bulk
+// add (loading a save) leaves the rankings to be rebuilt by the first call
+// that needs them.
+class Inventory {
+public:
+    static const std::uint32_t NO_ITEM = 0xFFFFFFFFu;
+    static const std::size_t MAX_ITEMS = 50000;
+    static const std::size_t CHUNK_ITEMS = 512;
+
+    Inventory();
+
+    std::uint32_t add(const Item& item);
+    // Adds items in order and returns their ids (stops early once full);
+    // the rankings are rebuilt once on first use instead of per item
+    std::vector<std::uint32_t> addAll(const std::vector<Item>& items);
+    // Removes an unequipped item and returns its gold value (0 if not removed)
+    int salvage(std::uint32_t id);
+    void clear();
+    // Clones every chunk and ranking still shared with other copies, so this
+    // copy can be mutated on another thread
+    void detach();
+
+    bool isAlive(std::uint32_t id) const;
+    const Item& get(std::uint32_t id) const;
+    std::size_t size() const;
+    bool isFull() const;
+    std::size_t countInSlot(EquipSlot slot) const;
+
+    // Equipment
+    std::uint32_t equipped(EquipSlot slot) const;
+    bool isEquipped(std::uint32_t id) const;
+    bool equip(std::uint32_t id);
+    std::uint32_t bestFor(EquipSlot slot, GearRank rank) const;
+    // Equips the best item per slot; returns how many slots changed
+    int equipBest(GearRank rank);
+    // Salvages every unequipped item ranked below the equipped one in its
+    // slot; returns the number of items removed and adds their value to gold
+    int salvageWorse(GearRank rank, int& gold);
+    const EquipmentBonus& bonuses() const;
+
+    // Live item ids in ascending order, for saving
+    std::vector<std::uint32_t> liveIds() const;
+
+private:
+    typedef std::array<Item, CHUNK_ITEMS> ItemChunk;
+    static const std::uint16_t NO_FREE = 0xFFFF;
+
+    std::vector<CowPtr<ItemChunk>> chunks;
+    std::uint32_t poolSize;     // Ids handed out so far, live or free
+    std::uint16_t freeHead;
+    std::array<std::array<RankIndex, GEAR_RANK_COUNT>, EQUIP_SLOT_COUNT> rankings;
+    bool ranked;                // False after addAll until the rankings are rebuilt
+    std::array<std::size_t, EQUIP_SLOT_COUNT> slotCounts;
+    std::array<std::uint32_t, EQUIP_SLOT_COUNT> equippedIds;
+    EquipmentBonus bonus;
+    std::size_t liveCount;
+
+    std::uint32_t allocate(const Item& item);
+    Item& edit(std::uint32_t id);
+    void release(std::uint32_t id);
+    void ensureRanked();
+    void index(std::uint32_t id);
+    void unindex(std::uint32_t id);
+    void recalculateBonuses();
+};
+
+static_assert(Inventory::MAX_ITEMS < 0xFFFF, "Free list links must fit in Item::nextFree");
+
+// Loot generation and display
+Item generateItem(int itemLevel, bool boss, std::mt19937& rng);
+std::string getSlotName(EquipSlot slot);
+std::string getRarityName(Rarity rarity);
+std::string describeItem(const Item& item);
+
+// Compact save encoding: each item packs into 3 + 2 * affixCount bytes
+// (slot, rarity and affix count, level, affixes), written as base64.
+// Decoding appends to items and fails on anything that is not a valid item.
+std::string encodeItems(const std::vector<Item>& items);
+bool decodeItems(const std::string& text, std::vector<Item>& items);
+
+#endif // LOOT_H
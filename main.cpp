@@ -1,13 +1,41 @@
 #include "game.h"
+#include "save_slots.h"
+#include "farming.h"
 #include <iostream>
 #include <fstream>
 
 int main() {
     GameState game;
+    SaveSlotManager slots;
+    CombatLog combatLog;
+    FarmingScheduler farming;
+    game.setCombatLog(&combatLog);
     
-    // Try to load saved game
+    if (!BalanceSheet::configError().empty()) {
+        std::cout << "⚠️  Ignoring " << BalanceSheet::CONFIG_FILE << " ("
+                  << BalanceSheet::configError() << "), using default balance.\n";
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+    
+    // Offer the most recently written slot, falling back to the legacy save
     std::ifstream checkFile("save_game.json");
-    if (checkFile.good()) {
+    if (const SlotInfo* latest = slots.latestSlot()) {
+        std::cout << "Found save slot '" << latest->name << "' (Lv " << latest->level
+                  << "). Load it? (y/n): ";
+        std::string response;
+        std::getline(std::cin, response);
+        
+        if (response == "y" || response == "Y") {
+            if (slots.loadLatest(latest->name, game)) {
+                std::cout << "Game loaded successfully!\n";
+            } else {
+                std::cout << "Failed to load game. Starting new game...\n";
+            }
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+        }
+    } else if (checkFile.good()) {
         checkFile.close();
         std::cout << "Found saved game. Load it? (y/n): ";
         std::string response;
@@ -44,23 +72,26 @@ int main() {
             statisticsMenu(game);
         } else if (choice == "4") {
             // Save game
-            if (game.saveGame()) {
-                std::cout << "\n💾 Game saved successfully!\n";
-            } else {
-                std::cout << "\n❌ Failed to save game!\n";
-            }
-            std::cout << "\nPress Enter to continue...";
-            std::cin.get();
+            saveSlotMenu(game, slots);
         } else if (choice == "5") {
             // Load game
-            if (game.loadGame()) {
+            if (loadSlotMenu(game, slots)) {
                 std::cout << "\n💾 Game loaded successfully!\n";
             } else {
-                std::cout << "\n❌ No save file found or failed to load!\n";
+                std::cout << "\n❌ No snapshot loaded!\n";
             }
             std::cout << "\nPress Enter to continue...";
             std::cin.get();
         } else if (choice == "6") {
+            // Combat log
+            combatLogMenu(game);
+        } else if (choice == "7") {
+            // Inventory
+            inventoryMenu(game);
+        } else if (choice == "8") {
+            // Farming queue
+            farmingMenu(game, farming);
+        } else if (choice == "9") {
             // Exit
             std::cout << "\n👋 Thanks for playing!\n";
             game.gameRunning = false;
@@ -0,0 +1,405 @@
+#include "save_slots.h"
+#include "game.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <cctype>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// Delta encoding
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+std::string encodeSaveDelta(const std::string& keyframe, const std::string& text) {
+    std::vector<std::string> base = splitLines(keyframe);
+    std::vector<std::string> lines = splitLines(text);
+
+    // First line holds the line count, then one "<index> <line>" per change
+    std::string delta = std::to_string(lines.size()) + "\n";
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        if (i >= base.size() || base[i] != lines[i]) {
+            delta += std::to_string(i) + " " + lines[i] + "\n";
+        }
+    }
+    return delta;
+}
+
+std::string applySaveDelta(const std::string& keyframe, const std::string& delta) {
+    std::vector<std::string> lines = splitLines(keyframe);
+    std::vector<std::string> changes = splitLines(delta);
+    if (changes.empty()) {
+        return keyframe;
+    }
+
+    lines.resize(std::stoul(changes[0]));
+    for (std::size_t i = 1; i < changes.size(); i++) {
+        std::size_t space = changes[i].find(' ');
+        std::size_t index = std::stoul(changes[i].substr(0, space));
+        if (index < lines.size()) {
+            lines[index] = space == std::string::npos ? "" : changes[i].substr(space + 1);
+        }
+    }
+
+    std::string text;
+    for (const auto& line : lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+// History file records
+static void writeRecord(std::ostream& out, char kind, std::int64_t timestamp,
+                        const std::string& payload) {
+    out << kind << ' ' << timestamp << ' ' << payload.size() << '\n';
+    out.write(payload.data(), payload.size());
+}
+
+// Writes text as a delta against keyframe, or as a new keyframe when the
+// delta would not save enough space. Updates keyframe when rebasing.
+static void writeEncoded(std::ostream& out, std::string& keyframe,
+                         const std::string& text, std::int64_t timestamp) {
+    if (!keyframe.empty()) {
+        std::string delta = encodeSaveDelta(keyframe, text);
+        if (delta.size() * 2 <= keyframe.size()) {
+            writeRecord(out, 'D', timestamp, delta);
+            return;
+        }
+    }
+    writeRecord(out, 'K', timestamp, text);
+    keyframe = text;
+}
+
+// Fails rather than allocating when the index points past the end of the
+// history file, as a stale or corrupt index can
+static bool readPayload(const std::string& path, const SnapshotInfo& info, std::string& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    if (info.offset < 0 || size < 0 || info.offset > size ||
+        info.length > static_cast<std::uint64_t>(size - info.offset)) {
+        return false;
+    }
+    out.resize(info.length);
+    file.seekg(info.offset);
+    file.read(&out[0], info.length);
+    return static_cast<std::size_t>(file.gcount()) == info.length;
+}
+
+// Index parsing helpers
+static std::string extractString(const std::string& line, const std::string& key) {
+    std::size_t pos = line.find("\"" + key + "\":");
+    if (pos == std::string::npos) {
+        return "";
+    }
+    std::size_t start = line.find('"', pos + key.size() + 3);
+    std::size_t end = line.find('"', start + 1);
+    if (start == std::string::npos || end == std::string::npos) {
+        return "";
+    }
+    return line.substr(start + 1, end - start - 1);
+}
+
+static std::int64_t extractInt(const std::string& line, const std::string& key) {
+    std::size_t pos = line.find("\"" + key + "\":");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    return std::stoll(line.substr(pos + key.size() + 3));
+}
+
+// SaveSlotManager implementation
+SaveSlotManager::SaveSlotManager(const std::string& dir) : directory(dir) {
+    loadIndex();
+}
+
+const std::vector<SlotInfo>& SaveSlotManager::listSlots() const {
+    return slots;
+}
+
+const SlotInfo* SaveSlotManager::findSlot(const std::string& slot) const {
+    for (const auto& info : slots) {
+        if (info.name == slot) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const SlotInfo* SaveSlotManager::latestSlot() const {
+    const SlotInfo* latest = nullptr;
+    for (const auto& info : slots) {
+        if (!latest || info.timestamp > latest->timestamp) {
+            latest = &info;
+        }
+    }
+    return latest;
+}
+
+bool SaveSlotManager::isValidSlotName(const std::string& slot) {
+    if (slot.empty() || slot.size() > MAX_SLOT_NAME) {
+        return false;
+    }
+    return std::all_of(slot.begin(), slot.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+    });
+}
+
+std::string SaveSlotManager::indexPath() const {
+    return directory + "/index.json";
+}
+
+std::string SaveSlotManager::historyPath(const std::string& slot) const {
+    return directory + "/" + slot + ".hist";
+}
+
+void SaveSlotManager::loadIndex() {
+    slots.clear();
+    std::ifstream file(indexPath());
+    if (!file.is_open()) {
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string name = extractString(line, "name");
+        if (!isValidSlotName(name)) {
+            continue;
+        }
+        try {
+            SlotInfo info;
+            info.name = name;
+            info.level = static_cast<int>(extractInt(line, "level"));
+            info.floorsCleared = static_cast<int>(extractInt(line, "floorsCleared"));
+            info.dungeonsCompleted = static_cast<int>(extractInt(line, "dungeonsCompleted"));
+            info.timestamp = extractInt(line, "timestamp");
+            info.snapshots = static_cast<int>(extractInt(line, "snapshots"));
+            slots.push_back(info);
+        } catch (...) {
+            // Skip malformed entries rather than losing the whole index
+        }
+    }
+}
+
+bool SaveSlotManager::writeIndex() const {
+    std::string tmpPath = indexPath() + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        file << "{\n";
+        file << "  \"slots\": [\n";
+        for (std::size_t i = 0; i < slots.size(); i++) {
+            const auto& info = slots[i];
+            file << "    {\"name\": \"" << info.name << "\""
+                 << ", \"level\": " << info.level
+                 << ", \"floorsCleared\": " << info.floorsCleared
+                 << ", \"dungeonsCompleted\": " << info.dungeonsCompleted
+                 << ", \"timestamp\": " << info.timestamp
+                 << ", \"snapshots\": " << info.snapshots << "}"
+                 << (i + 1 < slots.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, indexPath(), ec);
+    return !ec;
+}
+
+std::vector<SnapshotInfo> SaveSlotManager::listSnapshots(const std::string& slot) const {
+    std::vector<SnapshotInfo> snapshots;
+    if (!isValidSlotName(slot)) {
+        return snapshots;
+    }
+
+    std::ifstream file(historyPath(slot), std::ios::binary);
+    if (!file.is_open()) {
+        return snapshots;
+    }
+
+    // Only headers are read; payloads are skipped with a seek
+    int keyframeIndex = -1;
+    std::string header;
+    while (std::getline(file, header)) {
+        char kind = 0;
+        SnapshotInfo info;
+        std::istringstream parser(header);
+        if (!(parser >> kind >> info.timestamp >> info.length) ||
+            (kind != 'K' && kind != 'D') || (kind == 'D' && keyframeIndex < 0)) {
+            break;
+        }
+
+        info.keyframe = kind == 'K';
+        if (info.keyframe) {
+            keyframeIndex = static_cast<int>(snapshots.size());
+        }
+        info.keyframeIndex = keyframeIndex;
+        info.offset = static_cast<std::int64_t>(file.tellg());
+        file.seekg(static_cast<std::streamoff>(info.length), std::ios::cur);
+        snapshots.push_back(info);
+    }
+    return snapshots;
+}
+
+bool SaveSlotManager::readSnapshotText(const std::string& slot,
+                                       const std::vector<SnapshotInfo>& snapshots,
+                                       int index, std::string& out) const {
+    if (index < 0 || index >= static_cast<int>(snapshots.size())) {
+        return false;
+    }
+
+    const SnapshotInfo& info = snapshots[index];
+    std::string keyframe;
+    if (!readPayload(historyPath(slot), snapshots[info.keyframeIndex], keyframe)) {
+        return false;
+    }
+    if (info.keyframe) {
+        out = keyframe;
+        return true;
+    }
+
+    std::string delta;
+    if (!readPayload(historyPath(slot), info, delta)) {
+        return false;
+    }
+    try {
+        out = applySaveDelta(keyframe, delta);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool SaveSlotManager::compactHistory(const std::string& slot, const std::string& newest) {
+    auto snapshots = listSnapshots(slot);
+    std::size_t keep = MAX_SNAPSHOTS - 1;
+    std::size_t first = snapshots.size() > keep ? snapshots.size() - keep : 0;
+
+    // Decode the retained snapshots, then re-encode them with a fresh keyframe
+    std::string tmpPath = historyPath(slot) + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        std::string keyframe;
+        for (std::size_t i = first; i < snapshots.size(); i++) {
+            std::string text;
+            if (!readSnapshotText(slot, snapshots, static_cast<int>(i), text)) {
+                return false;
+            }
+            writeEncoded(out, keyframe, text, snapshots[i].timestamp);
+        }
+        writeEncoded(out, keyframe, newest, static_cast<std::int64_t>(std::time(nullptr)));
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, historyPath(slot), ec);
+    return !ec;
+}
+
+bool SaveSlotManager::saveSnapshot(const std::string& slot, const GameState& game) {
+    if (!isValidSlotName(slot)) {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        return false;
+    }
+
+    std::ostringstream serialized;
+    game.writeSave(serialized);
+    std::string text = serialized.str();
+
+    auto snapshots = listSnapshots(slot);
+    int count = static_cast<int>(snapshots.size()) + 1;
+    if (count > MAX_SNAPSHOTS + COMPACT_SLACK) {
+        if (!compactHistory(slot, text)) {
+            return false;
+        }
+        count = MAX_SNAPSHOTS;
+    } else {
+        std::string keyframe;
+        if (!snapshots.empty() &&
+            !readPayload(historyPath(slot), snapshots[snapshots.back().keyframeIndex], keyframe)) {
+            return false;
+        }
+
+        std::ofstream file(historyPath(slot), std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            return false;
+        }
+        writeEncoded(file, keyframe, text, static_cast<std::int64_t>(std::time(nullptr)));
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    const Player& player = game.getPlayer();
+    SlotInfo info = {slot, player.level, player.floorsCleared, player.dungeonsCompleted,
+                     static_cast<std::int64_t>(std::time(nullptr)), count};
+    auto existing = std::find_if(slots.begin(), slots.end(),
+                                 [&](const SlotInfo& s) { return s.name == slot; });
+    if (existing != slots.end()) {
+        *existing = info;
+    } else {
+        slots.push_back(info);
+    }
+    return writeIndex();
+}
+
+bool SaveSlotManager::loadSnapshot(const std::string& slot, int index, GameState& game) const {
+    std::string text;
+    if (!readSnapshotText(slot, listSnapshots(slot), index, text)) {
+        return false;
+    }
+    // Parsed into a copy so a corrupt snapshot leaves the live game untouched
+    std::istringstream in(text);
+    GameState loaded = game;
+    try {
+        if (!loaded.readSave(in)) {
+            return false;
+        }
+    } catch (...) {
+        return false;
+    }
+    game = loaded;
+    return true;
+}
+
+bool SaveSlotManager::loadLatest(const std::string& slot, GameState& game) const {
+    auto snapshots = listSnapshots(slot);
+    if (snapshots.empty()) {
+        return false;
+    }
+    return loadSnapshot(slot, static_cast<int>(snapshots.size()) - 1, game);
+}
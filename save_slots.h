@@ -0,0 +1,79 @@
+#ifndef SAVE_SLOTS_H
+#define SAVE_SLOTS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class GameState;
+
+// Slot metadata kept in the index file so the slot picker never opens a save
+struct SlotInfo {
+    std::string name;
+    int level;
+    int floorsCleared;
+    int dungeonsCompleted;
+    std::int64_t timestamp;
+    int snapshots;
+};
+
+// One record in a slot's history file
+struct SnapshotInfo {
+    bool keyframe;
+    std::int64_t timestamp;
+    std::int64_t offset;    // Byte offset of the payload in the history file
+    std::size_t length;     // Payload length in bytes
+    int keyframeIndex;      // Keyframe a delta applies to (itself for keyframes)
+};
+
+// Named save slots, each holding a history of delta-compressed snapshots.
+//
+// Layout on disk:
+//   <dir>/index.json      slot metadata for the picker
+//   <dir>/<slot>.hist     append-only snapshot records
+//
+// Each record is a header line "K|D <timestamp> <length>" followed by
+// <length> payload bytes. Keyframes store the full save text; deltas store
+// only the lines that differ from the preceding keyframe. A new keyframe is
+// written whenever a delta would exceed half of its keyframe's size.
+// Once a history grows past MAX_SNAPSHOTS + COMPACT_SLACK it is rewritten
+// down to the newest MAX_SNAPSHOTS, so compaction cost is amortized.
+class SaveSlotManager {
+public:
+    static const int MAX_SNAPSHOTS = 100;
+    static const int COMPACT_SLACK = 25;
+    static const std::size_t MAX_SLOT_NAME = 24;
+
+    explicit SaveSlotManager(const std::string& dir = "saves");
+
+    // Slots
+    const std::vector<SlotInfo>& listSlots() const;
+    const SlotInfo* findSlot(const std::string& slot) const;
+    const SlotInfo* latestSlot() const;
+    static bool isValidSlotName(const std::string& slot);
+
+    // Snapshots
+    bool saveSnapshot(const std::string& slot, const GameState& game);
+    bool loadSnapshot(const std::string& slot, int index, GameState& game) const;
+    bool loadLatest(const std::string& slot, GameState& game) const;
+    std::vector<SnapshotInfo> listSnapshots(const std::string& slot) const;
+
+private:
+    std::string directory;
+    std::vector<SlotInfo> slots;
+
+    std::string indexPath() const;
+    std::string historyPath(const std::string& slot) const;
+    void loadIndex();
+    bool writeIndex() const;
+    bool readSnapshotText(const std::string& slot, const std::vector<SnapshotInfo>& snapshots,
+                          int index, std::string& out) const;
+    bool compactHistory(const std::string& slot, const std::string& newest);
+};
+
+// Line-based delta encoding used by the snapshot history
+std::string encodeSaveDelta(const std::string& keyframe, const std::string& text);
+std::string applySaveDelta(const std::string& keyframe, const std::string& delta);
+
+#endif // SAVE_SLOTS_H
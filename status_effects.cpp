@@ -0,0 +1,64 @@
+#include "status_effects.h"
+
+std::string getElementName(Element element) {
+    switch (element) {
+        case Element::PHYSICAL: return "Physical";
+        case Element::FIRE: return "Fire";
+        case Element::FROST: return "Frost";
+        case Element::POISON: return "Poison";
+        case Element::LIGHTNING: return "Lightning";
+        default: return "Unknown";
+    }
+}
+
+std::string getStatusEffectName(StatusEffect effect) {
+    switch (effect) {
+        case StatusEffect::BURN: return "Burn";
+        case StatusEffect::FREEZE: return "Freeze";
+        case StatusEffect::POISON: return "Poison";
+        case StatusEffect::STUN: return "Stun";
+        default: return "Unknown";
+    }
+}
+
+std::string getStatusEffectIcon(StatusEffect effect) {
+    switch (effect) {
+        case StatusEffect::BURN: return "🔥";
+        case StatusEffect::FREEZE: return "❄️ ";
+        case StatusEffect::POISON: return "☠️ ";
+        case StatusEffect::STUN: return "💫";
+        default: return "❔";
+    }
+}
+
+std::string describeStatusEffects(const StatusEffects& effects) {
+    std::string text;
+    for (std::uint32_t mask = effects.active; mask != 0; mask &= mask - 1) {
+        StatusEffect effect = static_cast<StatusEffect>(lowestSetBit(mask));
+        int turns = effects.turnsLeft(effect);
+        // Past its first turn a stun only blocks new stuns, which is not worth showing
+        if (effect == StatusEffect::STUN) {
+            if (turns <= STUN_IMMUNE_TURNS) {
+                continue;
+            }
+            turns -= STUN_IMMUNE_TURNS;
+        }
+        text += (text.empty() ? "" : ", ") + getStatusEffectIcon(effect) + " " +
+                getStatusEffectName(effect) + " (" + std::to_string(turns) + ")";
+    }
+    return text;
+}
+
+std::string describeResistances(const std::array<int, ELEMENT_COUNT>& resistPercent) {
+    std::string text;
+    for (std::size_t e = 1; e < ELEMENT_COUNT; e++) {
+        int percent = resistPercent[e];
+        if (percent == 0) {
+            continue;
+        }
+        text += (text.empty() ? "" : ", ") + std::string(percent > 0 ? "resists " : "weak to ") +
+                getElementName(static_cast<Element>(e)) + " " +
+                std::to_string(percent > 0 ? percent : -percent) + "%";
+    }
+    return text;
+}
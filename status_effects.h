@@ -0,0 +1,254 @@
+#ifndef STATUS_EFFECTS_H
+#define STATUS_EFFECTS_H
+
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+enum class Element : std::uint8_t {
+    PHYSICAL,
+    FIRE,
+    FROST,
+    POISON,
+    LIGHTNING,
+    COUNT
+};
+
+enum class StatusEffect : std::uint8_t {
+    BURN,       // Fire damage each turn
+    FREEZE,     // Deals less damage
+    POISON,     // Poison damage each turn, weaker but longer than burn
+    STUN,       // Loses a turn, then cannot be stunned again for a while
+    COUNT
+};
+
+const std::size_t ELEMENT_COUNT = static_cast<std::size_t>(Element::COUNT);
+const std::size_t STATUS_EFFECT_COUNT = static_cast<std::size_t>(StatusEffect::COUNT);
+
+// Resistance cap for the player; negative resistance is a weakness
+const int MAX_RESIST_PERCENT = 75;
+// Turns after a stun during which another stun does not take hold
+const int STUN_IMMUNE_TURNS = 3;
+
+// Index of the lowest set bit; mask must be non-zero
+inline unsigned lowestSetBit(std::uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline std::uint8_t statusBit(StatusEffect effect) {
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned>(effect));
+}
+
+inline std::uint8_t elementBit(Element element) {
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned>(element));
+}
+
+// Each non-physical element inflicts the effect listed at its position
+// (fire burns, frost freezes, poison poisons, lightning stuns), so the
+// effects of a set of elements are a single shift of their mask
+static_assert(static_cast<int>(Element::FIRE) == static_cast<int>(StatusEffect::BURN) + 1 &&
+              static_cast<int>(Element::FROST) == static_cast<int>(StatusEffect::FREEZE) + 1 &&
+              static_cast<int>(Element::POISON) == static_cast<int>(StatusEffect::POISON) + 1 &&
+              static_cast<int>(Element::LIGHTNING) == static_cast<int>(StatusEffect::STUN) + 1,
+              "Elements and the effects they inflict must line up");
+
+inline std::uint8_t elementEffects(std::uint8_t elementMask) {
+    return static_cast<std::uint8_t>(elementMask >> 1);
+}
+
+inline Element effectElement(StatusEffect effect) {
+    return static_cast<Element>(static_cast<int>(effect) + 1);
+}
+
+// Spreads bit i of mask to the low bit of byte i
+inline std::uint32_t spreadBits(std::uint8_t mask) {
+    return (mask * 0x00204081u) & 0x01010101u;
+}
+
+// Gathers the low bit of byte i of spread into bit i; the inverse of spreadBits
+inline std::uint8_t gatherBits(std::uint32_t spread) {
+    return static_cast<std::uint8_t>(((spread & 0x01010101u) * 0x01020408u) >> 24) & 0x0F;
+}
+
+struct StatusEffectRule {
+    std::uint8_t turns;
+    std::uint8_t percent;   // Of the inflicting hit per turn (burn, poison) or damage lost (freeze)
+    Element damage;         // Element of the damage over time, PHYSICAL for none
+};
+
+constexpr StatusEffectRule STATUS_EFFECT_RULES[STATUS_EFFECT_COUNT] = {
+    {3, 30, Element::FIRE},
+    {2, 30, Element::PHYSICAL},
+    {5, 15, Element::POISON},
+    {1 + STUN_IMMUNE_TURNS, 0, Element::PHYSICAL}
+};
+
+constexpr std::uint32_t packRuleTurns() {
+    std::uint32_t packed = 0;
+    for (std::size_t e = 0; e < STATUS_EFFECT_COUNT; e++) {
+        packed |= static_cast<std::uint32_t>(STATUS_EFFECT_RULES[e].turns) << (8 * e);
+    }
+    return packed;
+}
+
+constexpr std::uint8_t packDamageEffects() {
+    std::uint8_t mask = 0;
+    for (std::size_t e = 0; e < STATUS_EFFECT_COUNT; e++) {
+        if (STATUS_EFFECT_RULES[e].damage != Element::PHYSICAL) {
+            mask |= static_cast<std::uint8_t>(1u << e);
+        }
+    }
+    return mask;
+}
+
+// Effects that deal damage over time
+constexpr std::uint8_t STATUS_DAMAGE_EFFECTS = packDamageEffects();
+
+// The rules' turns, a byte per effect
+constexpr std::uint32_t STATUS_EFFECT_TURNS = packRuleTurns();
+
+// What a combatant's effects do to its turn
+struct StatusTurn {
+    int damage;         // Burn and poison, after resistances
+    int damagePercent;  // Of normal damage dealt this turn
+    bool stunned;
+
+    // Damage dealt this turn from a normal amount
+    int scale(int damage) const {
+        return damagePercent == 100 ? damage : damage * damagePercent / 100;
+    }
+};
+
+// Timed effects on one combatant: a bit per active effect, the turns left
+// packed a byte per effect into one word, and per-effect potency. Burn and
+// poison damage is resisted when applied and kept as a running total, so a
+// turn costs the same however many effects are active: every duration is
+// aged by one subtraction, and only the bits of effects that expire or are
+// applied are visited.
+struct StatusEffects {
+    std::uint8_t active;
+    std::uint32_t turns;
+    std::array<std::uint16_t, STATUS_EFFECT_COUNT> potency;
+    int damagePerTurn;
+
+    StatusEffects() : active(0), turns(0), potency(), damagePerTurn(0) {}
+
+    bool any() const { return active != 0; }
+    bool has(StatusEffect effect) const { return (active & statusBit(effect)) != 0; }
+    int turnsLeft(StatusEffect effect) const {
+        return (turns >> (8 * static_cast<unsigned>(effect))) & 0xFF;
+    }
+    void clear() {
+        active = 0;
+        turns = 0;
+        damagePerTurn = 0;
+    }
+
+    // Restarts every effect in effects that is already active, except a
+    // running stun, and returns the ones that are not for apply(). Keeping
+    // an effect up is the common case, and costs the same for any number.
+    std::uint8_t refresh(std::uint8_t effects) {
+        const std::uint8_t renew = effects & active & static_cast<std::uint8_t>(~statusBit(StatusEffect::STUN));
+        const std::uint32_t bytes = spreadBits(renew) * 0xFFu;
+        turns = (turns & ~bytes) | (STATUS_EFFECT_TURNS & bytes);
+        return effects & static_cast<std::uint8_t>(~active);
+    }
+
+    // Potency of an effect started by a hit of hitDamage on a target with
+    // the given resistances: damage per turn for burn and poison, fixed at
+    // this point, and the rule's percent for the others
+    static std::uint16_t potencyOf(StatusEffect effect, int hitDamage,
+                                   const std::array<int, ELEMENT_COUNT>& resistPercent) {
+        const StatusEffectRule& rule = STATUS_EFFECT_RULES[static_cast<std::size_t>(effect)];
+        if (rule.damage == Element::PHYSICAL) {
+            return rule.percent;
+        }
+        int value = std::max(1, hitDamage * rule.percent / 100);
+        value = value * (100 - resistPercent[static_cast<std::size_t>(rule.damage)]) / 100;
+        return static_cast<std::uint16_t>(std::min(value, 0xFFFF));
+    }
+
+    // Starts an effect from a hit of hitDamage on a target with the given
+    // resistances. Returns false if it was already active, which refreshes
+    // it like refresh().
+    bool apply(StatusEffect effect, int hitDamage, const std::array<int, ELEMENT_COUNT>& resistPercent) {
+        if (active & statusBit(effect)) {
+            refresh(statusBit(effect));
+            return false;
+        }
+        std::array<std::uint16_t, STATUS_EFFECT_COUNT> effectPotency = {};
+        effectPotency[static_cast<std::size_t>(effect)] = potencyOf(effect, hitDamage, resistPercent);
+        start(statusBit(effect), effectPotency);
+        return true;
+    }
+
+    // Starts every effect in effects, none of them active, with potencies
+    // already resolved for this target (as returned by refresh(), for hits
+    // whose potency does not change). Selects per effect rather than
+    // branching, so any set costs the same.
+    void start(std::uint8_t effects, const std::array<std::uint16_t, STATUS_EFFECT_COUNT>& effectPotency) {
+        for (std::size_t e = 0; e < STATUS_EFFECT_COUNT; e++) {
+            const bool starts = (effects >> e) & 1u;
+            potency[e] = starts ? effectPotency[e] : potency[e];
+            damagePerTurn += starts && ((STATUS_DAMAGE_EFFECTS >> e) & 1u) ? effectPotency[e] : 0;
+        }
+        const std::uint32_t bytes = spreadBits(effects) * 0xFFu;
+        turns = (turns & ~bytes) | (STATUS_EFFECT_TURNS & bytes);
+        active |= effects;
+    }
+
+    // Starts the owner's turn: reports what the effects do to it, then ages
+    // every effect by one turn and clears the expired ones
+    StatusTurn beginTurn() {
+        static_assert(STATUS_EFFECT_COUNT <= 4, "Turns are packed a byte per effect into 32 bits");
+
+        // Selects rather than branches: which effects are up changes from
+        // turn to turn, which a branch predictor handles poorly
+        StatusTurn turn = {damagePerTurn, 100, false};
+        const int frozen = potency[static_cast<std::size_t>(StatusEffect::FREEZE)];
+        turn.damagePercent = has(StatusEffect::FREEZE) ? 100 - frozen : 100;
+        // Inactive bytes are zero, so this needs no check that a stun is up
+        turn.stunned = turnsLeft(StatusEffect::STUN) > STUN_IMMUNE_TURNS;
+
+        // One subtraction ages every active effect; inactive bytes stay zero
+        turns -= spreadBits(active);
+        // Turns never exceed 0x7F, so adding 0x7F sets a byte's top bit
+        // exactly when it is non-zero
+        const std::uint32_t running = (turns + 0x7F7F7F7Fu) & 0x80808080u;
+        const std::uint8_t expired = active & static_cast<std::uint8_t>(~gatherBits(running >> 7));
+        active &= static_cast<std::uint8_t>(~expired);
+        if (expired & STATUS_DAMAGE_EFFECTS) {
+            expire(expired & STATUS_DAMAGE_EFFECTS);
+        }
+        return turn;
+    }
+
+private:
+    // Drops the damage of expired damage over time effects
+    void expire(std::uint8_t expired) {
+        for (std::uint32_t mask = expired; mask != 0; mask &= mask - 1) {
+            damagePerTurn -= potency[lowestSetBit(mask)];
+        }
+    }
+};
+
+std::string getElementName(Element element);
+std::string getStatusEffectName(StatusEffect effect);
+std::string getStatusEffectIcon(StatusEffect effect);
+// "🔥 Burn (2), 💫 Stun (1)"; empty when nothing is active
+std::string describeStatusEffects(const StatusEffects& effects);
+// "resists Fire 50%, weak to Frost 50%"; empty when all are zero
+std::string describeResistances(const std::array<int, ELEMENT_COUNT>& resistPercent);
+
+#endif // STATUS_EFFECTS_H
@@ -22,7 +22,7 @@ echo ""
 
 # Test 2: Check if game launches and exits properly
 echo "Test 2: Testing game launch and exit..."
-echo "6" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
+echo "9" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
 if [ $? -eq 0 ]; then
     echo "✅ Game launches and exits correctly"
 else
@@ -32,7 +32,7 @@ echo ""
 
 # Test 3: Test statistics menu
 echo "Test 3: Testing statistics menu..."
-echo -e "3\n6\n" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
+echo -e "3\n9\n" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
 if [ $? -eq 0 ]; then
     echo "✅ Statistics menu works"
 else
@@ -42,10 +42,10 @@ echo ""
 
 # Test 4: Test save game
 echo "Test 4: Testing save game functionality..."
-echo -e "4\n6\n" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
-if [ -f "save_game.json" ]; then
+echo -e "4\nn\ntest\n\n9\n" | timeout 5 ./dungeon_crawler > /dev/null 2>&1
+if [ -f "saves/index.json" ] && [ -f "saves/test.hist" ]; then
     echo "✅ Save game created"
-    rm -f save_game.json
+    rm -rf saves
 else
     echo "❌ Save game not created"
 fi
@@ -53,7 +53,7 @@ echo ""
 
 # Test 5: Test entering dungeon and fleeing
 echo "Test 5: Testing dungeon entry and flee..."
-echo -e "1\n1\n1\n3\n6\n" | timeout 10 ./dungeon_crawler > /dev/null 2>&1
+echo -e "1\n1\n1\n3\n9\n" | timeout 10 ./dungeon_crawler > /dev/null 2>&1
 if [ $? -eq 0 ]; then
     echo "✅ Dungeon entry and flee works"
 else